@@ -42,6 +42,14 @@ Vectorf BitmapText::getSize() const
     return size;
 }
 
+Rectf BitmapText::getLocalBounds() const
+{
+    // Each glyph is drawn with the font's own scale, a glyph further along
+    const Vectorf scale = font_.getScale();
+    return {0.f, 0.f, glyphDims_.x * text_.size() * scale.x,
+            glyphDims_.y * scale.y};
+}
+
 void BitmapText::draw(Vectorf parentPos, float parentRot, Vectorf parentOri,
                       Camera const& cam)
 {
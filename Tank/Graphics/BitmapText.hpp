@@ -66,6 +66,7 @@ public:
      * \brief Return the size of the current string
      */
     virtual Vectorf getSize() const override;
+    virtual Rectf getLocalBounds() const override;
 
     virtual Vector<unsigned int> getTextureSize() const
     {
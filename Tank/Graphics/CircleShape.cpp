@@ -44,11 +44,17 @@ Vectorf CircleShape::getSize() const
     return {rect.width, rect.height};
 }
 
+Rectf CircleShape::getLocalBounds() const
+{
+    auto rect = circleShape_.getLocalBounds();
+    return {rect.left, rect.top, rect.width, rect.height};
+}
+
 void CircleShape::draw(tank::Vectorf parentPos, float parentRot,
                        Vectorf parentOri, tank::Camera const& cam)
 {
     Graphic::transform(this, parentPos, parentRot, parentOri, cam,
                        circleShape_);
-    Game::window()->SFMLWindow().draw(circleShape_);
+    Game::window()->draw(circleShape_);
 }
 }
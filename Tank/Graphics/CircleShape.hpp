@@ -36,6 +36,7 @@ public:
     virtual float getOutlineThickness() const override;
 
     virtual Vectorf getSize() const override;
+    virtual Rectf getLocalBounds() const override;
 
     virtual void draw(Vectorf parentPos = {}, float parentRot = 0,
                       Vectorf parentOri = {},
@@ -20,6 +20,12 @@ Vectorf ConvexShape::getSize() const
     return {rect.width, rect.height};
 }
 
+Rectf ConvexShape::getLocalBounds() const
+{
+    auto rect = convexShape_.getLocalBounds();
+    return {rect.left, rect.top, rect.width, rect.height};
+}
+
 void ConvexShape::setFillColor(Color c)
 {
     convexShape_.setFillColor(c);
@@ -60,6 +66,6 @@ void ConvexShape::draw(Vectorf parentPos, float parentRot, Vectorf parentOri,
 {
     Graphic::transform(this, parentPos, parentRot, parentOri, cam,
                        convexShape_);
-    tank::Game::window()->SFMLWindow().draw(convexShape_);
+    tank::Game::window()->draw(convexShape_);
 }
 }
@@ -27,6 +27,7 @@ public:
     virtual float getOutlineThickness() const override final;
 
     virtual Vectorf getSize() const override final;
+    virtual Rectf getLocalBounds() const override final;
 
     void setPoints(std::vector<Vectorf> const& points);
 
@@ -85,7 +85,8 @@ public:
                 std::function<void()> callback = [] {});
 
     /*!
-     * \brief Update the animation to the current frame. Called by draw
+     * \brief Update the animation to the current frame. Called by draw, and
+     * by skipDraw when the frame list is culled
      */
     void refresh();
 
@@ -101,6 +102,15 @@ public:
                       Vectorf parentOri = {},
                       Camera const& = Camera()) override;
 
+    /*!
+     * \brief Advances the animation without drawing it, so that it keeps
+     * time and its callback fires while culled
+     */
+    void skipDraw() override
+    {
+        refresh();
+    }
+
     /*!
      * \brief Start the animation
      */
@@ -158,6 +168,7 @@ public:
     Vectorf getOrigin() const override { return image_.getOrigin(); }
     void setSize(Vectorf size) { image_.setSize(size); }
     Vectorf getSize() const override { return image_.getSize(); }
+    Rectf getLocalBounds() const override { return image_.getLocalBounds(); }
 
 
     Vectoru getFrameDimensions() const { return frameDimensions_; }
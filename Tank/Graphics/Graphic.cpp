@@ -6,9 +6,49 @@
 #include <SFML/Graphics/Transformable.hpp>
 #include "Graphic.hpp"
 
+#include <algorithm>
+#include <limits>
+
 namespace tank
 {
 
+Rectd Graphic::getBounds(Vectorf parentPos, float parentRot) const
+{
+    // The model half of transform()
+    Vectord pos = getPos();
+    double rot = getRotation();
+    if (isRelativeToParent()) {
+        pos = pos.rotate(parentRot) + Vectord{parentPos};
+        rot += parentRot;
+    }
+
+    const Vectord scale = getScale();
+    const Vectord origin = getOrigin();
+    const Rectd local = getLocalBounds();
+    const Vectord corners[] = {{local.x, local.y},
+                               {local.x + local.w, local.y},
+                               {local.x, local.y + local.h},
+                               {local.x + local.w, local.y + local.h}};
+
+    double left = std::numeric_limits<double>::infinity();
+    double top = left;
+    double right = -left;
+    double bottom = -left;
+    for (auto const& corner : corners) {
+        Vectord world = corner - origin;
+        world.x *= scale.x;
+        world.y *= scale.y;
+        world = world.rotate(rot) + pos;
+
+        left = std::min(left, world.x);
+        top = std::min(top, world.y);
+        right = std::max(right, world.x);
+        bottom = std::max(bottom, world.y);
+    }
+
+    return {left, top, right - left, bottom - top};
+}
+
 void Graphic::transform(Graphic const* g, Vectorf parentPos, float parentRot,
                         Vectorf parentOri, Camera const& cam,
                         sf::Transformable& t)
@@ -127,10 +127,41 @@ public:
                         localCoords.y<0 or localCoords.y> size.y);
     }
 
+    /*!
+     * \brief Returns the area the graphic covers, in its own coordinates:
+     * before its origin, scale and rotation are applied
+     *
+     * By default this is the rectangle from (0, 0) to getSize().
+     */
+    virtual Rectf getLocalBounds() const
+    {
+        const Vectorf size = getSize();
+        return {0.f, 0.f, size.x, size.y};
+    }
+
+    /*!
+     * \brief Returns the smallest rectangle containing the graphic, in world
+     * coordinates, as it would be drawn with the given parent transform
+     *
+     * \param parentPos The position of the parent, as passed to draw()
+     * \param parentRot The rotation of the parent, as passed to draw()
+     */
+    Rectd getBounds(Vectorf parentPos = {}, float parentRot = 0) const;
+
     // TODO: Make const
     virtual void draw(Vectorf parentPos = {}, float parentRot = 0,
                       Vectorf parentOri = {}, Camera const& = Camera()) = 0;
 
+    /*!
+     * \brief Called in place of draw() when the graphic is culled
+     *
+     * Graphics that change as they are drawn, like FrameList, carry on here,
+     * so that they don't freeze while out of view.
+     */
+    virtual void skipDraw()
+    {
+    }
+
 protected:
     static void transform(Graphic const* g, Vectorf parentPos, float parentRot,
                           Vectorf parentOri, Camera const& cam,
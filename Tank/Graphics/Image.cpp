@@ -75,7 +75,7 @@ void Image::draw(Vectorf parentPos,
     */
 
     Graphic::transform(this, parentPos, parentRot, parentOri, cam, sprite_);
-    Game::window()->SFMLWindow().draw(sprite_);
+    Game::window()->draw(sprite_, texture_);
 
     // setScale(modelScale);
     // sprite_.setScale({modelScale.x, modelScale.y});
@@ -38,6 +38,12 @@ public:
         return {rect.width, rect.height};
     }
 
+    virtual Rectf getLocalBounds() const override
+    {
+        auto rect = sprite_.getLocalBounds();
+        return {rect.left, rect.top, rect.width, rect.height};
+    }
+
     /*
     virtual void setScale(float scale) override
     {
@@ -55,6 +55,12 @@ Vectorf RectangleShape::getSize() const
     return {rect.width, rect.height};
 }
 
+Rectf RectangleShape::getLocalBounds() const
+{
+    auto rect = rectangleShape_.getLocalBounds();
+    return {rect.left, rect.top, rect.width, rect.height};
+}
+
 void RectangleShape::draw(Vectorf parentPos,
                           float parentRot,
                           Vectorf parentOri,
@@ -62,7 +68,7 @@ void RectangleShape::draw(Vectorf parentPos,
 {
     Graphic::transform(this, parentPos, parentRot, parentOri,
                        cam, rectangleShape_);
-    Game::window()->SFMLWindow().draw(rectangleShape_);
+    Game::window()->draw(rectangleShape_);
 }
 
 
@@ -29,6 +29,7 @@ public:
 
     virtual void setSize(Vectorf);
     virtual Vectorf getSize() const override;
+    virtual Rectf getLocalBounds() const override;
 
     virtual void draw(Vectorf parentPos = {}, float parentRot = 0,
                       Vectorf parentOri = {},
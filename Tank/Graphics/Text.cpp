@@ -13,6 +13,6 @@ void Text::draw(Vectorf parentPos, float parentRot, Vectorf parentOri,
                 Camera const& cam)
 {
     Graphic::transform(this, parentPos, parentRot, parentOri, cam, text_);
-    Game::window()->SFMLWindow().draw(text_);
+    Game::window()->draw(text_, font_);
 }
 }
@@ -13,14 +13,26 @@
 #include "Font.hpp"
 #include "Color.hpp"
 
+#include <memory>
 #include <string>
 
 namespace tank
 {
 
+/*!
+ * \brief A Graphic drawing a string in a Font
+ *
+ * A font given by shared pointer is kept alive for as long as the text uses
+ * it, including while a render thread draws it. A font given by reference
+ * must outlive the text, and if the window renders on its own thread, the
+ * frame after the text was last drawn.
+ *
+ * \see Window::setThreadedRendering()
+ */
 class Text : public Graphic
 {
     sf::Text text_;
+    std::shared_ptr<Font const> font_;
 
 public:
     Text() = default;
@@ -29,12 +41,23 @@ public:
             : text_(text, f, size)
     {
     }
+    Text(std::shared_ptr<Font const> f, unsigned size = 30,
+         std::string text = "")
+            : text_(text, *f, size), font_(std::move(f))
+    {
+    }
 
     ~Text() = default;
 
     void setFont(Font& f)
     {
         text_.setFont(f);
+        font_.reset();
+    }
+    void setFont(std::shared_ptr<Font const> f)
+    {
+        text_.setFont(*f);
+        font_ = std::move(f);
     }
 
     void setFontSize(unsigned s)
@@ -60,6 +83,12 @@ public:
         return {text_.getLocalBounds().width, text_.getLocalBounds().height};
     }
 
+    virtual Rectf getLocalBounds() const override
+    {
+        auto rect = text_.getLocalBounds();
+        return {rect.left, rect.top, rect.width, rect.height};
+    }
+
     virtual void setColor(const Color& color)
     {
         text_.setColor(color);
@@ -81,6 +81,14 @@ public:
         return {size.x * tiles_.getWidth(), size.y * tiles_.getHeight()};
     }
 
+    virtual Rectf getLocalBounds() const override
+    {
+        Rectf tile = Image::getLocalBounds();
+        tile.w *= tiles_.getWidth();
+        tile.h *= tiles_.getHeight();
+        return tile;
+    }
+
     /*!
      * \brief This sets the clip rectangle by tiling the region and selecting
      * the tile designated by index. It has an option of setting an additional
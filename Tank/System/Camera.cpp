@@ -5,6 +5,8 @@
 
 #include "Camera.hpp"
 
+#include <algorithm>
+#include <limits>
 #include "Game.hpp"
 
 namespace tank
@@ -12,9 +14,40 @@ namespace tank
 
 Camera::Camera()
 {
-    if (Game::window()) {
-        origin_ = Game::window()->getSize() / 2;
+    origin_ = Game::screenSize() / 2;
+}
+
+Rectd Camera::getViewBounds(Vectoru screenSize) const
+{
+    // The inverse of the view transform in Graphic::transform()
+    const Vectord zoom = zoom_;
+    const Vectord origin = origin_;
+    const Vectord pos = pos_;
+    const Vectord shift = Vectord{pos.x * zoom.x, pos.y * zoom.y}.rotate(rot_);
+
+    const Vectord corners[] = {{0, 0},
+                               {static_cast<double>(screenSize.x), 0},
+                               {0, static_cast<double>(screenSize.y)},
+                               {static_cast<double>(screenSize.x),
+                                static_cast<double>(screenSize.y)}};
+
+    double left = std::numeric_limits<double>::infinity();
+    double top = left;
+    double right = -left;
+    double bottom = -left;
+    for (auto const& corner : corners) {
+        Vectord world = corner - origin + shift;
+        world.x /= zoom.x;
+        world.y /= zoom.y;
+        world = world.rotate(-rot_) + origin;
+
+        left = std::min(left, world.x);
+        top = std::min(top, world.y);
+        right = std::max(right, world.x);
+        bottom = std::max(bottom, world.y);
     }
+
+    return {left, top, right - left, bottom - top};
 }
 
 } /* tank */
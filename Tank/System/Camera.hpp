@@ -6,6 +6,7 @@
 #ifndef TANK_CAMERA_HPP
 #define TANK_CAMERA_HPP
 
+#include "../Utility/Rect.hpp"
 #include "../Utility/Vector.hpp"
 
 namespace tank
@@ -65,6 +66,16 @@ public:
         return (screenCoords - getOrigin()).rotate(-getRotation()) / getZoom();
     }
 
+    /*!
+     * \brief Returns the smallest rectangle containing every point in the
+     * world that the camera shows on a screen of the given size
+     *
+     * With the camera rotated this is larger than the screen itself.
+     *
+     * \param screenSize The size of the screen, in pixels
+     */
+    Rectd getViewBounds(Vectoru screenSize) const;
+
     Camera();
     Camera(Camera const&) = default;
     Camera& operator=(Camera const&) = default;
@@ -0,0 +1,324 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_CONDITIONS_HPP
+#define TANK_CONDITIONS_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "InputSource.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief Base of the condition types that compose with `&&`, `||` and
+ * fnot()
+ *
+ * A condition expression is a function object returning bool which can also
+ * say which inputs it reads. Combining expressions builds a new type rather
+ * than wrapping each side in a std::function, so
+ * `Keyboard::KeyDown(Key::A) && Keyboard::Shift` is a small object whose
+ * call inlines down to three array lookups. It is only type-erased once,
+ * when passed to EventHandler.connect().
+ *
+ * Besides `bool operator()() const`, an expression has:
+ *
+ * - `bool isIndexed() const`, whether every part of it reads only inputs
+ * - `void appendSources(std::vector<InputSource>&) const`, adding the inputs
+ *   it reads
+ *
+ * \see EventHandler::Condition
+ */
+struct ConditionExpression
+{
+};
+
+template <typename T>
+struct IsCondition
+        : std::is_base_of<ConditionExpression, typename std::decay<T>::type>
+{
+};
+
+/*!
+ * \brief A condition that reads nothing but the given inputs
+ *
+ * \tparam Test A function object returning bool
+ * \tparam N The number of inputs
+ */
+template <typename Test, std::size_t N = 1>
+class InputCondition : public ConditionExpression
+{
+    Test test_;
+    std::array<InputSource, N> sources_;
+
+public:
+    InputCondition(Test test, std::array<InputSource, N> sources)
+            : test_(test), sources_(sources)
+    {
+    }
+
+    bool operator()() const
+    {
+        return test_();
+    }
+
+    bool isIndexed() const
+    {
+        return true;
+    }
+
+    void appendSources(std::vector<InputSource>& sources) const
+    {
+        sources.insert(sources.end(), sources_.begin(), sources_.end());
+    }
+};
+
+/*!
+ * \brief A condition made from any function, checked every frame
+ */
+template <typename F>
+class PolledCondition : public ConditionExpression
+{
+    mutable F test_;
+
+public:
+    explicit PolledCondition(F test) : test_(std::move(test))
+    {
+    }
+
+    bool operator()() const
+    {
+        return test_();
+    }
+
+    bool isIndexed() const
+    {
+        return false;
+    }
+
+    void appendSources(std::vector<InputSource>&) const
+    {
+    }
+};
+
+template <typename L, typename R>
+class AndCondition : public ConditionExpression
+{
+    L l_;
+    R r_;
+
+public:
+    AndCondition(L l, R r) : l_(std::move(l)), r_(std::move(r))
+    {
+    }
+
+    bool operator()() const
+    {
+        return l_() and r_();
+    }
+
+    bool isIndexed() const
+    {
+        return l_.isIndexed() and r_.isIndexed();
+    }
+
+    void appendSources(std::vector<InputSource>& sources) const
+    {
+        l_.appendSources(sources);
+        r_.appendSources(sources);
+    }
+};
+
+template <typename L, typename R>
+class OrCondition : public ConditionExpression
+{
+    L l_;
+    R r_;
+
+public:
+    OrCondition(L l, R r) : l_(std::move(l)), r_(std::move(r))
+    {
+    }
+
+    bool operator()() const
+    {
+        return l_() or r_();
+    }
+
+    bool isIndexed() const
+    {
+        return l_.isIndexed() and r_.isIndexed();
+    }
+
+    void appendSources(std::vector<InputSource>& sources) const
+    {
+        l_.appendSources(sources);
+        r_.appendSources(sources);
+    }
+};
+
+template <typename C>
+class NotCondition : public ConditionExpression
+{
+    C c_;
+
+public:
+    explicit NotCondition(C c) : c_(std::move(c))
+    {
+    }
+
+    bool operator()() const
+    {
+        return not c_();
+    }
+
+    bool isIndexed() const
+    {
+        return c_.isIndexed();
+    }
+
+    void appendSources(std::vector<InputSource>& sources) const
+    {
+        c_.appendSources(sources);
+    }
+};
+
+/*!
+ * \brief The expression type a function object becomes when combined: itself
+ * if it is already an expression, otherwise a PolledCondition
+ */
+template <typename T>
+using AsCondition = typename std::conditional<
+        IsCondition<T>::value, typename std::decay<T>::type,
+        PolledCondition<typename std::decay<T>::type>>::type;
+
+namespace detail
+{
+template <typename T>
+AsCondition<T> asCondition(T&& c, std::true_type /* is condition */)
+{
+    return std::forward<T>(c);
+}
+
+template <typename T>
+AsCondition<T> asCondition(T&& f, std::false_type /* is condition */)
+{
+    return AsCondition<T>{std::forward<T>(f)};
+}
+
+template <typename T>
+using IsTest = std::is_convertible<T, std::function<bool()>>;
+
+// Whether `l && r` should make an expression: both must be conditions, and
+// at least one an expression, leaving two std::functions to the overloads
+// taking std::function
+template <typename L, typename R>
+struct AreConditionOperands
+        : std::integral_constant<bool,
+                                 (IsCondition<L>::value or
+                                  IsCondition<R>::value) and
+                                         IsTest<L>::value and IsTest<R>::value>
+{
+};
+
+/* Tests for InputCondition, calling a function fixed at compile time */
+
+template <bool (*Test)()>
+struct CallTest
+{
+    bool operator()() const
+    {
+        return Test();
+    }
+};
+
+template <typename Arg, bool (*Test)(Arg)>
+struct CallTestWith
+{
+    Arg arg;
+
+    bool operator()() const
+    {
+        return Test(arg);
+    }
+};
+
+template <typename T, bool (T::*Test)() const>
+struct CallMemberTest
+{
+    T const* object;
+
+    bool operator()() const
+    {
+        return (object->*Test)();
+    }
+};
+
+template <typename T, typename Arg, bool (T::*Test)(Arg) const>
+struct CallMemberTestWith
+{
+    T const* object;
+    Arg arg;
+
+    bool operator()() const
+    {
+        return (object->*Test)(arg);
+    }
+};
+} // detail
+
+template <typename T>
+AsCondition<T> asCondition(T&& c)
+{
+    return detail::asCondition(std::forward<T>(c), IsCondition<T>{});
+}
+
+/*!
+ * \brief Returns a condition that holds when c doesn't
+ */
+template <typename C,
+          typename = typename std::enable_if<detail::IsTest<C>::value>::type>
+NotCondition<AsCondition<C>> fnot(C&& c)
+{
+    return NotCondition<AsCondition<C>>{asCondition(std::forward<C>(c))};
+}
+
+// Found by argument-dependent lookup, as one side is always a tank type
+template <typename L, typename R,
+          typename = typename std::enable_if<
+                  detail::AreConditionOperands<L, R>::value>::type>
+AndCondition<AsCondition<L>, AsCondition<R>> operator&&(L&& l, R&& r)
+{
+    return {asCondition(std::forward<L>(l)), asCondition(std::forward<R>(r))};
+}
+
+template <typename L, typename R,
+          typename = typename std::enable_if<
+                  detail::AreConditionOperands<L, R>::value>::type>
+OrCondition<AsCondition<L>, AsCondition<R>> operator||(L&& l, R&& r)
+{
+    return {asCondition(std::forward<L>(l)), asCondition(std::forward<R>(r))};
+}
+
+} // tank
+
+inline std::function<bool()> operator&&(std::function<bool()> f1,
+                                        std::function<bool()> f2)
+{
+    return [f1, f2]() { return f1() && f2(); };
+}
+
+inline std::function<bool()> operator||(std::function<bool()> f1,
+                                        std::function<bool()> f2)
+{
+    return [f1, f2]() { return f1() || f2(); };
+}
+
+#endif /* TANK_CONDITIONS_HPP */
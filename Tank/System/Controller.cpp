@@ -89,6 +89,18 @@ void Controller::reset()
     connectedLast_ = connectedState_;
 }
 
+std::array<InputSource, 2> Controller::buttonSources(unsigned button) const
+{
+    return {{InputSource::controllerButton(id_, button),
+             InputSource::controllerConnection(id_)}};
+}
+
+std::array<InputSource, 2> Controller::axisSources(unsigned axis) const
+{
+    return {{InputSource::controllerAxis(id_, axis),
+             InputSource::controllerConnection(id_)}};
+}
+
 bool Controller::buttonPressed(unsigned button) const
 {
     return buttonStates_[button] and not buttonLast_[button];
@@ -97,11 +109,13 @@ bool Controller::buttonPressed(Button button) const
 {
     return buttonPressed(static_cast<unsigned>(button));
 }
-std::function<bool()> Controller::ButtonPress(unsigned button) const
+Controller::ButtonCondition<&Controller::buttonPressed>
+        Controller::ButtonPress(unsigned button) const
 {
-    return [=] { return buttonPressed(button); };
+    return {{this, button}, buttonSources(button)};
 }
-std::function<bool()> Controller::ButtonPress(Button button) const
+Controller::ButtonCondition<&Controller::buttonPressed>
+        Controller::ButtonPress(Button button) const
 {
     return ButtonPress(static_cast<unsigned>(button));
 }
@@ -114,11 +128,13 @@ bool Controller::buttonReleased(Button button) const
 {
     return buttonReleased(static_cast<unsigned>(button));
 }
-std::function<bool()> Controller::ButtonRelease(unsigned button) const
+Controller::ButtonCondition<&Controller::buttonReleased>
+        Controller::ButtonRelease(unsigned button) const
 {
-    return [=] { return buttonReleased(button); };
+    return {{this, button}, buttonSources(button)};
 }
-std::function<bool()> Controller::ButtonRelease(Button button) const
+Controller::ButtonCondition<&Controller::buttonReleased>
+        Controller::ButtonRelease(Button button) const
 {
     return ButtonRelease(static_cast<unsigned>(button));
 }
@@ -131,11 +147,13 @@ bool Controller::buttonDown(Button button) const
 {
     return buttonDown(static_cast<unsigned>(button));
 }
-std::function<bool()> Controller::ButtonDown(unsigned button) const
+Controller::ButtonCondition<&Controller::buttonDown>
+        Controller::ButtonDown(unsigned button) const
 {
-    return [=] { return buttonDown(button); };
+    return {{this, button}, buttonSources(button)};
 }
-std::function<bool()> Controller::ButtonDown(Button button) const
+Controller::ButtonCondition<&Controller::buttonDown>
+        Controller::ButtonDown(Button button) const
 {
     return ButtonDown(static_cast<unsigned>(button));
 }
@@ -148,32 +166,50 @@ bool Controller::buttonUp(Button button) const
 {
     return buttonUp(static_cast<unsigned>(button));
 }
-std::function<bool()> Controller::ButtonUp(unsigned button) const
+Controller::ButtonCondition<&Controller::buttonUp>
+        Controller::ButtonUp(unsigned button) const
 {
-    return [=] { return buttonUp(button); };
+    return {{this, button}, buttonSources(button)};
 }
-std::function<bool()> Controller::ButtonUp(Button button) const
+Controller::ButtonCondition<&Controller::buttonUp>
+        Controller::ButtonUp(Button button) const
 {
     return ButtonUp(static_cast<unsigned>(button));
 }
 
-std::function<bool()> Controller::AxisMoved(unsigned axis,
-                                            double threshold) const
+bool Controller::AxisMovedTest::operator()() const
 {
-    return [=] { return std::fabs(axisDelta(axis)) > threshold; };
+    return std::fabs(controller->axisDelta(axis)) > threshold;
 }
-std::function<bool()> Controller::AxisMoved(Axis axis, double threshold) const
+
+Controller::AxisCondition Controller::AxisMoved(unsigned axis,
+                                                double threshold) const
+{
+    return {{this, axis, threshold}, axisSources(axis)};
+}
+Controller::AxisCondition Controller::AxisMoved(Axis axis,
+                                                double threshold) const
 {
     return AxisMoved(static_cast<unsigned>(axis), threshold);
 }
 
-std::function<bool()> Controller::Connected() const
+bool Controller::justConnected() const
+{
+    return connectedState_ and not connectedLast_;
+}
+bool Controller::justDisconnected() const
+{
+    return connectedLast_ and not connectedState_;
+}
+Controller::ConnectionCondition<&Controller::justConnected>
+        Controller::Connected() const
 {
-    return [&] { return connectedState_ and not connectedLast_; };
+    return {{this}, {{InputSource::controllerConnection(id_)}}};
 }
-std::function<bool()> Controller::Disconnected() const
+Controller::ConnectionCondition<&Controller::justDisconnected>
+        Controller::Disconnected() const
 {
-    return [&] { return connectedLast_ and not connectedState_; };
+    return {{this}, {{InputSource::controllerConnection(id_)}}};
 }
 
 double Controller::axisPosition(unsigned axis) const
@@ -24,6 +24,7 @@
 #include <vector>
 #include <SFML/Window/Joystick.hpp>
 #include "../Utility/Vector.hpp"
+#include "EventHandler.hpp"
 #include "../Utility/observing_ptr.hpp"
 
 namespace tank
@@ -39,42 +40,74 @@ class Controller
     std::array<bool, sf::Joystick::ButtonCount> buttonStates_{};
     std::array<bool, sf::Joystick::ButtonCount> buttonLast_{};
 
+    // The inputs read by conditions on a button or axis. Disconnecting
+    // clears every button and axis, so that counts too.
+    std::array<InputSource, 2> buttonSources(unsigned button) const;
+    std::array<InputSource, 2> axisSources(unsigned axis) const;
+
+    bool justConnected() const;
+    bool justDisconnected() const;
+
+    struct AxisMovedTest
+    {
+        Controller const* controller;
+        unsigned axis;
+        double threshold;
+
+        bool operator()() const;
+    };
+
 public:
     enum class Button;
     enum class Axis;
 
+    /*! \brief Condition type reading one button */
+    template <bool (Controller::*Test)(unsigned) const>
+    using ButtonCondition = InputCondition<
+            detail::CallMemberTestWith<Controller, unsigned, Test>, 2>;
+
+    /*! \brief Condition type reading whether the controller is connected */
+    template <bool (Controller::*Test)() const>
+    using ConnectionCondition =
+            InputCondition<detail::CallMemberTest<Controller, Test>>;
+
+    using AxisCondition = InputCondition<AxisMovedTest, 2>;
+
     Controller(unsigned id);
 
     bool buttonPressed(unsigned button) const;
     bool buttonPressed(Button button) const;
-    std::function<bool()> ButtonPress(unsigned button) const;
-    std::function<bool()> ButtonPress(Button button) const;
+    ButtonCondition<&Controller::buttonPressed>
+            ButtonPress(unsigned button) const;
+    ButtonCondition<&Controller::buttonPressed>
+            ButtonPress(Button button) const;
 
     bool buttonReleased(unsigned button) const;
     bool buttonReleased(Button button) const;
-    std::function<bool()> ButtonRelease(unsigned button) const;
-    std::function<bool()> ButtonRelease(Button button) const;
+    ButtonCondition<&Controller::buttonReleased>
+            ButtonRelease(unsigned button) const;
+    ButtonCondition<&Controller::buttonReleased>
+            ButtonRelease(Button button) const;
 
     bool buttonDown(unsigned button) const;
     bool buttonDown(Button button) const;
-    std::function<bool()> ButtonDown(unsigned button) const;
-    std::function<bool()> ButtonDown(Button button) const;
+    ButtonCondition<&Controller::buttonDown> ButtonDown(unsigned button) const;
+    ButtonCondition<&Controller::buttonDown> ButtonDown(Button button) const;
 
     bool buttonUp(unsigned button) const;
     bool buttonUp(Button button) const;
-    std::function<bool()> ButtonUp(unsigned button) const;
-    std::function<bool()> ButtonUp(Button button) const;
+    ButtonCondition<&Controller::buttonUp> ButtonUp(unsigned button) const;
+    ButtonCondition<&Controller::buttonUp> ButtonUp(Button button) const;
 
-    std::function<bool()> AxisMoved(unsigned axis,
-                                    double threshold = 0.05) const;
-    std::function<bool()> AxisMoved(Axis axis, double threshold = 0.05) const;
+    AxisCondition AxisMoved(unsigned axis, double threshold = 0.05) const;
+    AxisCondition AxisMoved(Axis axis, double threshold = 0.05) const;
 
     bool isConnected() const
     {
         return connectedState_;
     }
-    std::function<bool()> Connected() const;
-    std::function<bool()> Disconnected() const;
+    ConnectionCondition<&Controller::justConnected> Connected() const;
+    ConnectionCondition<&Controller::justDisconnected> Disconnected() const;
 
     double axisPosition(unsigned axis) const;
     double axisPosition(Axis axis) const;
@@ -0,0 +1,132 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "DrawList.hpp"
+
+#include <algorithm>
+
+namespace tank
+{
+
+namespace
+{
+template <typename T>
+void keep(std::vector<std::shared_ptr<T>>& list, std::size_t index,
+          std::shared_ptr<T> resource)
+{
+    if (index < list.size()) {
+        list[index] = std::move(resource);
+    } else {
+        list.push_back(std::move(resource));
+    }
+}
+}
+
+template <typename T>
+std::size_t DrawList::store(std::vector<T>& list, std::size_t& count,
+                            T const& drawable)
+{
+    // Assign over last frame's copies so their buffers get reused
+    if (count < list.size()) {
+        list[count] = drawable;
+    } else {
+        list.push_back(drawable);
+    }
+    return count++;
+}
+
+void DrawList::record(Kind kind, std::size_t index)
+{
+    if (not commands_.empty() and commands_.back().layer > layer_) {
+        sorted_ = false;
+    }
+    commands_.push_back({kind, layer_, index});
+}
+
+void DrawList::add(sf::Sprite const& sprite,
+                   std::shared_ptr<Texture const> texture)
+{
+    const std::size_t index = store(sprites_, spriteCount_, sprite);
+    keep(textures_, index, std::move(texture));
+    record(Kind::Sprite, index);
+}
+
+void DrawList::add(sf::CircleShape const& circle)
+{
+    record(Kind::Circle, store(circles_, circleCount_, circle));
+}
+
+void DrawList::add(sf::RectangleShape const& rectangle)
+{
+    record(Kind::Rectangle, store(rectangles_, rectangleCount_, rectangle));
+}
+
+void DrawList::add(sf::ConvexShape const& convex)
+{
+    record(Kind::Convex, store(convexShapes_, convexCount_, convex));
+}
+
+void DrawList::add(sf::Text const& text, std::shared_ptr<Font const> font)
+{
+    const std::size_t index = store(texts_, textCount_, text);
+    keep(fonts_, index, std::move(font));
+    record(Kind::Text, index);
+}
+
+void DrawList::replay(sf::RenderWindow& window)
+{
+    if (not sorted_) {
+        std::stable_sort(commands_.begin(), commands_.end(),
+                         [](Command const& a, Command const& b) {
+            return a.layer < b.layer;
+        });
+        sorted_ = true;
+    }
+
+    for (auto const& command : commands_) {
+        switch (command.kind) {
+        case Kind::Sprite:
+            window.draw(sprites_[command.index]);
+            break;
+        case Kind::Circle:
+            window.draw(circles_[command.index]);
+            break;
+        case Kind::Rectangle:
+            window.draw(rectangles_[command.index]);
+            break;
+        case Kind::Convex:
+            window.draw(convexShapes_[command.index]);
+            break;
+        case Kind::Text:
+            window.draw(texts_[command.index]);
+            break;
+        }
+    }
+}
+
+void DrawList::clear()
+{
+    commands_.clear();
+
+    // Let go of textures and fonts, but keep the drawables around to copy
+    // over
+    for (std::size_t i = 0; i < spriteCount_; ++i) {
+        textures_[i].reset();
+    }
+    for (std::size_t i = 0; i < textCount_; ++i) {
+        fonts_[i].reset();
+    }
+
+    spriteCount_ = 0;
+    circleCount_ = 0;
+    rectangleCount_ = 0;
+    convexCount_ = 0;
+    textCount_ = 0;
+
+    layer_ = 0;
+    sorted_ = true;
+}
+
+} // tank
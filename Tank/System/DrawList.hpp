@@ -0,0 +1,131 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_DRAWLIST_HPP
+#define TANK_DRAWLIST_HPP
+
+#include <memory>
+#include <vector>
+#include <SFML/Graphics/CircleShape.hpp>
+#include <SFML/Graphics/ConvexShape.hpp>
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include "../Graphics/Color.hpp"
+#include "../Graphics/Font.hpp"
+#include "../Graphics/Texture.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief A recorded frame of draw calls, to be replayed later.
+ *
+ * Each call stores a copy of the already-transformed SFML object, along with
+ * the layer it was drawn on. Sprites can also hold on to their texture, and
+ * text to its font, so that it outlives the Graphic that drew it until the
+ * frame has been replayed. The list also keeps the color the window is
+ * cleared to after the frame, as it was when the frame was finished.
+ *
+ * Copies are kept in one list per kind of object, and are reused from frame
+ * to frame, so recording a frame similar to the last one doesn't allocate.
+ *
+ * Window uses two of these to draw on a separate thread.
+ *
+ * \see Window::setThreadedRendering()
+ */
+class DrawList
+{
+    enum class Kind : unsigned char
+    {
+        Sprite,
+        Circle,
+        Rectangle,
+        Convex,
+        Text
+    };
+
+    struct Command
+    {
+        Kind kind;
+        int layer;
+        std::size_t index;
+    };
+
+    std::vector<Command> commands_;
+
+    std::vector<sf::Sprite> sprites_;
+    std::vector<std::shared_ptr<Texture const>> textures_;
+    std::vector<sf::CircleShape> circles_;
+    std::vector<sf::RectangleShape> rectangles_;
+    std::vector<sf::ConvexShape> convexShapes_;
+    std::vector<sf::Text> texts_;
+    std::vector<std::shared_ptr<Font const>> fonts_;
+
+    std::size_t spriteCount_{0};
+    std::size_t circleCount_{0};
+    std::size_t rectangleCount_{0};
+    std::size_t convexCount_{0};
+    std::size_t textCount_{0};
+
+    int layer_{0};
+    bool sorted_{true};
+    Color clearColor_;
+
+public:
+    /*!
+     * \brief Sets the layer that following draw calls are recorded on
+     *
+     * Calls are replayed in layer order, and in the order they were recorded
+     * within a layer.
+     */
+    void setLayer(int layer)
+    {
+        layer_ = layer;
+    }
+
+    void add(sf::Sprite const&, std::shared_ptr<Texture const> = nullptr);
+    void add(sf::CircleShape const&);
+    void add(sf::RectangleShape const&);
+    void add(sf::ConvexShape const&);
+    void add(sf::Text const&, std::shared_ptr<Font const> = nullptr);
+
+    void setClearColor(Color color)
+    {
+        clearColor_ = color;
+    }
+
+    Color getClearColor() const
+    {
+        return clearColor_;
+    }
+
+    /*!
+     * \brief Draws every recorded call to the window
+     */
+    void replay(sf::RenderWindow& window);
+
+    /*!
+     * \brief Forgets every recorded call, keeping the memory for next frame
+     */
+    void clear();
+
+    std::size_t size() const
+    {
+        return commands_.size();
+    }
+
+private:
+    void record(Kind kind, std::size_t index);
+
+    template <typename T>
+    static std::size_t store(std::vector<T>& list, std::size_t& count,
+                             T const& drawable);
+};
+
+} // tank
+
+#endif /* TANK_DRAWLIST_HPP */
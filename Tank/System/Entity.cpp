@@ -6,70 +6,151 @@
 #include "Entity.hpp"
 
 #include <cmath>
+#include <limits>
 #include <stdexcept>
 #include <algorithm>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext.hpp>
 #include "Game.hpp"
 #include "World.hpp"
+#include "../Utility/SweptRect.hpp"
 
 namespace tank
 {
 
 int Entity::numEnts_ = 0;
 
-Entity::Entity(Vectorf pos) : pos_(pos), actorID_(numEnts_++)
+Entity::Entity(Vectorf pos)
+        : handle_(EntityHandle::acquire(this))
+        , actorID_(numEnts_++)
 {
+    // Until it is listed in a world, the entity's transform is kept by
+    // handle index
+    slot_ = handle_.index();
+    transforms_ = &Transforms::unlisted();
+    transforms_->reserve(slot_);
+    transform_ = &transforms_->block(slot_);
+    transformIndex_ = slot_ % Transforms::blockSize;
+
+    transform_->pos[transformIndex_] = pos;
+    transform_->lastPos[transformIndex_] = pos;
+    transform_->rot[transformIndex_] = 0;
+    transform_->lastRot[transformIndex_] = 0;
+    transform_->origin[transformIndex_] = {};
+    transform_->hitbox[transformIndex_] = {};
 }
 
 Entity::~Entity()
 {
+    EntityHandle::release(handle_);
+}
+
+void Entity::moveTransform(Transforms& to, std::uint32_t slot)
+{
+    to.reserve(slot);
+    Transforms::copy(*transforms_, slot_, to, slot);
+    transforms_ = &to;
+    slot_ = slot;
+    transform_ = &to.block(slot);
+    transformIndex_ = slot % Transforms::blockSize;
 }
 
 void Entity::draw(Camera const& cam)
+{
+    const float alpha = getAlpha();
+    const auto pos = getInterpolatedPos(alpha);
+    const auto rot = getInterpolatedRotation(alpha);
+
+    // World has checked the entity as a whole is in view, which for a single
+    // graphic is all there is to check
+    const bool cull = graphics_.size() > 1 and world_ and world_->drawing_ and
+                      world_->culling_;
+
+    for (auto& g : graphics_) {
+        if (not g->isVisible()) {
+            continue;
+        }
+        if (not cull or world_->inView(g->getBounds(pos, rot))) {
+            g->draw(pos, rot, getOrigin(), cam);
+        } else {
+            g->skipDraw();
+        }
+    }
+}
+
+void Entity::skipDraw()
 {
     for (auto& g : graphics_) {
         if (g->isVisible()) {
-            g->draw(getPos(), getRotation(), getOrigin(), cam);
+            g->skipDraw();
         }
     }
 }
 
-std::vector<observing_ptr<Entity>>
-        Entity::collide(std::vector<std::string> colTypes)
+Rectd Entity::getDrawBounds() const
 {
-    std::vector<std::unique_ptr<Entity>> const& orig = world_->getEntities();
-    std::vector<observing_ptr<Entity>> ents;
-    std::vector<observing_ptr<Entity>> collisions;
+    if (graphics_.empty()) {
+        constexpr double big = std::numeric_limits<double>::max();
+        return {-big / 2, -big / 2, big, big};
+    }
+
+    const float alpha = getAlpha();
+    const auto pos = getInterpolatedPos(alpha);
+    const auto rot = getInterpolatedRotation(alpha);
+
+    // With no visible graphics the bounds are NaN, which overlap nothing
+    double left = std::numeric_limits<double>::quiet_NaN();
+    double top = left;
+    double right = left;
+    double bottom = left;
+    for (auto const& g : graphics_) {
+        if (not g->isVisible()) {
+            continue;
+        }
 
-    for (auto& unique : orig) {
-        if (not unique->getTypes().empty()) {
-            ents.emplace_back(unique);
+        const Rectd bounds = g->getBounds(pos, rot);
+        if (not (left <= bounds.x)) {
+            left = bounds.x;
+        }
+        if (not (top <= bounds.y)) {
+            top = bounds.y;
+        }
+        if (not (right >= bounds.x + bounds.w)) {
+            right = bounds.x + bounds.w;
+        }
+        if (not (bottom >= bounds.y + bounds.h)) {
+            bottom = bounds.y + bounds.h;
         }
     }
 
-    if (not colTypes.empty()) {
-        ents.erase(
-                std::remove_if(ents.begin(), ents.end(),
-                               [&colTypes](observing_ptr<Entity> const& ent) {
-                    auto& entTypes = ent->getTypes();
-                    return std::find_first_of(entTypes.begin(), entTypes.end(),
-                                              colTypes.begin(),
-                                              colTypes.end()) == entTypes.end();
-                }),
-                ents.end());
+    return {left, top, right - left, bottom - top};
+}
+
+std::vector<observing_ptr<Entity>> Entity::collide(
+        TypeTag::Query const& colTypes)
+{
+    std::vector<Entity*> candidates;
+    std::vector<observing_ptr<Entity>> ents;
+    std::vector<observing_ptr<Entity>> collisions;
+
+    world_->collisionCandidates(getWorldHitbox(), candidates);
+    for (Entity* candidate : candidates) {
+        if (candidate->isType(colTypes)) {
+            ents.emplace_back(candidate);
+        }
     }
 
     for (auto& ent : ents) {
         if (ent != this) {
-            Rectd const& A = hitbox_;
+            Rectd const& A = getHitbox();
+            Vectorf const& pos = getPos();
             Rectd const& B = ent->getHitbox();
 
-            const double leftA = A.x + pos_.x;
+            const double leftA = A.x + pos.x;
             const double leftB = B.x + ent->getPos().x;
             const double rightA = leftA + A.w;
             const double rightB = leftB + B.w;
-            const double topA = A.y + pos_.y;
+            const double topA = A.y + pos.y;
             const double topB = B.y + ent->getPos().y;
             const double bottomA = topA + A.h;
             const double bottomB = topB + B.h;
@@ -86,6 +167,25 @@ std::vector<observing_ptr<Entity>>
     return collisions;
 }
 
+float Entity::getAlpha() const
+{
+    return world_ ? world_->getAlpha() : 1.f;
+}
+
+float Entity::getInterpolatedRotation(float alpha) const
+{
+    // Take the shortest way round
+    const float rot = transform_->rot[transformIndex_];
+    const float lastRot = transform_->lastRot[transformIndex_];
+    float delta = std::fmod(rot - lastRot, 360.f);
+    if (delta > 180.f) {
+        delta -= 360.f;
+    } else if (delta < -180.f) {
+        delta += 360.f;
+    }
+    return lastRot + delta * alpha;
+}
+
 std::unique_ptr<Graphic> const& Entity::getGraphic(unsigned int i) const
 {
     if (i < graphics_.size()) {
@@ -127,7 +227,10 @@ void Entity::clearGraphics()
 
 void Entity::setPos(Vectorf pos)
 {
-    pos_ = pos;
+    transform_->pos[transformIndex_] = pos;
+    if (world_) {
+        world_->boundsChanged(this);
+    }
 }
 
 // Note: In hindsight, this isn't such a good idea. The only useful condition
@@ -177,39 +280,178 @@ void Entity::moveBy(Vectorf disp)
     setPos(getPos() + disp);
 }
 
+SweepResult Entity::sweep(Vectorf disp, TypeTag::Query const& types)
+{
+    SweepResult result;
+    if (not world_ or (disp.x == 0 and disp.y == 0)) {
+        return result;
+    }
+
+    const Rectd box = getWorldHitbox();
+    const Vectord delta = disp;
+
+    // Everything the hitbox passes over
+    const double left = std::min(box.x, box.x + box.w);
+    const double top = std::min(box.y, box.y + box.h);
+    const Rectd path{std::min(left, left + delta.x),
+                     std::min(top, top + delta.y),
+                     std::abs(box.w) + std::abs(delta.x),
+                     std::abs(box.h) + std::abs(delta.y)};
+
+    std::vector<Entity*> candidates;
+    world_->collisionCandidates(path, candidates);
+    for (Entity* candidate : candidates) {
+        if (candidate == this or not candidate->isType(types)) {
+            continue;
+        }
+
+        double time;
+        Vectord normal;
+        if (sweepRect(box, delta, candidate->getWorldHitbox(), time, normal) and
+            time < result.time) {
+            result.hit = true;
+            result.time = time;
+            result.normal = normal;
+            result.other = candidate;
+        }
+    }
+
+    const double unmoved = 1 - result.time;
+    result.remaining = {static_cast<float>(delta.x * unmoved),
+                        static_cast<float>(delta.y * unmoved)};
+    return result;
+}
+
+SweepResult Entity::moveAndSlide(Vectorf disp, TypeTag::Query const& types,
+                                 unsigned maxSlides)
+{
+    SweepResult result;
+    Vectorf left = disp;
+
+    for (unsigned i = 0; i <= maxSlides and (left.x != 0 or left.y != 0);
+         ++i) {
+        const SweepResult step = sweep(left, types);
+        setPos(getPos() + (left - step.remaining));
+        left = step.remaining;
+        if (not step.hit) {
+            break;
+        }
+
+        if (not result.hit) {
+            result.time = step.time;
+        }
+        result.hit = true;
+        result.normal = step.normal;
+        result.other = step.other;
+
+        // Keep only the part along the surface
+        if (step.normal.x != 0) {
+            left.x = 0;
+        } else {
+            left.y = 0;
+        }
+    }
+
+    result.remaining = left;
+    return result;
+}
+
+TerrainMove Entity::moveAgainst(Terrain const& terrain, Vectorf disp)
+{
+    const TerrainMove result = terrain.move(getWorldHitbox(), disp);
+    if (result.moved.x != 0 or result.moved.y != 0) {
+        setPos(getPos() + Vectorf(result.moved));
+    }
+    return result;
+}
+
 void Entity::setRotation(float rot)
 {
-    rot_ = rot;
+    transform_->rot[transformIndex_] = rot;
 }
 
 void Entity::setOrigin(Vectorf origin)
 {
-    origin_ = origin;
+    transform_->origin[transformIndex_] = origin;
 }
 
 void Entity::setHitbox(Rectd hitbox)
 {
-    hitbox_ = hitbox;
+    transform_->hitbox[transformIndex_] = hitbox;
+    if (world_) {
+        world_->boundsChanged(this);
+    }
 }
 
 void Entity::setType(std::string type)
 {
-    types_.clear();
-    types_.push_back(type);
+    const std::size_t id = TypeTag::intern(type);
+    const bool listed = world_ and world_->isListed(this);
+    if (listed) {
+        world_->removeFromTypeLists(this);
+    }
+
+    types_ = &TypeTag::single(id);
+    ownTypes_.clear();
+    typeIds_.clear();
+    typeIds_.push_back(id);
+    typeSlots_.clear();
+    typeSlots_.push_back(0);
+    typeMask_ = TypeTag::bit(id);
+
+    if (listed) {
+        world_->addToTypeLists(this);
+    }
 }
 
 void Entity::addType(std::string type)
 {
     if (type == "")
         return;
-    if (std::find(types_.begin(), types_.end(), type) == types_.end()) {
-        types_.push_back(type);
+
+    const std::size_t id = TypeTag::intern(type);
+    if (std::find(typeIds_.begin(), typeIds_.end(), id) != typeIds_.end()) {
+        return;
+    }
+
+    if (types_ != &ownTypes_) {
+        ownTypes_.reserve(types_->size() + 1);
+        ownTypes_.assign(types_->begin(), types_->end());
+        types_ = &ownTypes_;
+    }
+    ownTypes_.push_back(std::move(type));
+    typeIds_.push_back(id);
+    typeSlots_.push_back(0);
+    typeMask_ |= TypeTag::bit(id);
+
+    if (world_ and world_->isListed(this)) {
+        world_->addToTypeLists(this, typeIds_.size() - 1);
+    }
+}
+
+void Entity::setCollisionEvents(bool enabled)
+{
+    if (enabled == collisionEvents_) {
+        return;
+    }
+
+    collisionEvents_ = enabled;
+    if (world_ and world_->isListed(this)) {
+        world_->collisionEventsChanged(this);
     }
 }
 
 void Entity::setLayer(int layer)
 {
+    if (layer == layer_) {
+        return;
+    }
+
+    const int oldLayer = layer_;
     layer_ = layer;
+    if (world_) {
+        world_->layerChanged(this, oldLayer);
+    }
 }
 
 void Entity::setWorld(const observing_ptr<World> world)
@@ -221,34 +463,71 @@ observing_ptr<EventHandler::Connection>
         Entity::connect(EventHandler::Condition condition,
                         EventHandler::Effect effect)
 {
-    auto cond = getWorld()->eventHandler.connect(condition, effect);
-    connections_.push_back(std::move(cond));
+    // Firing wakes the entity, so it can react in update()
+    EventHandler::Effect wakeAndFire = [this, effect] {
+        wake();
+        effect();
+    };
+    connections_.emplace_back(new EventHandler::Connection{
+            getWorld()->eventHandler.connect(std::move(condition),
+                                             std::move(wakeAndFire))});
     return connections_.back();
 }
 
-bool Entity::offScreen() const
+void Entity::setUpdatePolicy(UpdatePolicy policy)
 {
-    auto pos = getPos();
-    auto size = getGraphic()->getSize();
+    updatePolicy_ = policy;
+    scheduled_ = asleep_ or policy.interval > 1 or
+                 policy.radius < std::numeric_limits<double>::infinity();
+    elapsedTicks_ = 1;
+    if (world_) {
+        lastUpdate_ = world_->tick_;
+    }
+}
 
-    if (pos.y + size.y < 0 || pos.y > Game::window()->getSize().y ||
-        pos.x + size.x < 0 || pos.x > Game::window()->getSize().x) {
-        return true;
+void Entity::wake()
+{
+    if (not asleep_) {
+        return;
     }
 
-    return false;
+    asleep_ = false;
+    setUpdatePolicy(updatePolicy_);
+}
+
+float Entity::getElapsedTime() const
+{
+    return static_cast<float>(elapsedTicks_) / Game::fps;
+}
+
+bool Entity::offScreen() const
+{
+    const Rectd bounds = getDrawBounds();
+    const Rectd view = screenBounds();
+
+    return not (bounds.x <= view.x + view.w and
+                view.x <= bounds.x + bounds.w and
+                bounds.y <= view.y + view.h and
+                view.y <= bounds.y + bounds.h);
 }
 
 bool Entity::onScreen() const
 {
-    auto pos = getPos();
-    auto size = getGraphic()->getSize();
+    const Rectd bounds = getDrawBounds();
+    const Rectd view = screenBounds();
+
+    return bounds.x >= view.x and bounds.x + bounds.w <= view.x + view.w and
+           bounds.y >= view.y and bounds.y + bounds.h <= view.y + view.h;
+}
 
-    if (pos.y < 0 || pos.y + size.y > Game::window()->getSize().y ||
-        pos.x < 0 || pos.x + size.x > Game::window()->getSize().x) {
-        return false;
+Rectd Entity::screenBounds() const
+{
+    const Vectoru screen = Game::screenSize();
+    if (world_) {
+        return world_->camera.getViewBounds(screen);
     }
-    return true;
+    return {0.0, 0.0, static_cast<double>(screen.x),
+            static_cast<double>(screen.y)};
 }
 
 bool Entity::partOffScreen() const
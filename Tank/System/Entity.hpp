@@ -9,18 +9,85 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <limits>
 #include "../Graphics/Graphic.hpp"
 #include "../Graphics/Image.hpp"
 #include "../Utility/observing_ptr.hpp"
 #include "../Utility/Rect.hpp"
+#include "../Utility/SmallVector.hpp"
+#include "../Utility/SpatialHash.hpp"
+#include "../Utility/Terrain.hpp"
 #include "../Utility/Vector.hpp"
 #include "Camera.hpp"
+#include "EntityHandle.hpp"
+#include "EntityPool.hpp"
 #include "EventHandler.hpp"
+#include "Transforms.hpp"
+#include "TypeTag.hpp"
 
 namespace tank
 {
 
 class World;
+class Entity;
+
+/*!
+ * \brief How often World updates an entity
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     // Every fourth tick, and only within 2000 of the camera or a focus
+ *     setUpdatePolicy(UpdatePolicy::every(4).within(2000));
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * \see Entity.setUpdatePolicy()
+ */
+struct UpdatePolicy
+{
+    /*! \brief Ticks from one update to the next */
+    unsigned interval {1};
+    /*! \brief How close the entity must be to a focus point to update */
+    double radius {std::numeric_limits<double>::infinity()};
+
+    /*! \brief Update every tick, wherever the entity is (the default) */
+    static UpdatePolicy everyTick()
+    {
+        return {};
+    }
+
+    /*! \brief Update every n ticks */
+    static UpdatePolicy every(unsigned n)
+    {
+        UpdatePolicy policy;
+        policy.interval = n > 0 ? n : 1;
+        return policy;
+    }
+
+    /*! \brief The same policy, only near a focus point */
+    UpdatePolicy within(double distance) const
+    {
+        UpdatePolicy policy = *this;
+        policy.radius = distance;
+        return policy;
+    }
+};
+
+/*!
+ * \brief The outcome of Entity.sweep() or Entity.moveAndSlide()
+ */
+struct SweepResult
+{
+    /*! \brief Whether another entity was in the way */
+    bool hit {false};
+    /*! \brief The fraction of the displacement moved before the first hit */
+    double time {1};
+    /*! \brief Unit vector out of the side of other that was hit */
+    Vectord normal {};
+    /*! \brief The part of the displacement that wasn't moved */
+    Vectorf remaining {};
+    /*! \brief The entity hit (the last one, for Entity.moveAndSlide()) */
+    observing_ptr<Entity> other {nullptr};
+};
 
 /*!
  * \brief Base class for all game entities.
@@ -44,21 +111,57 @@ class World;
  */
 class Entity
 {
-    Vectorf pos_;
-    float rot_{};
-    Vectorf origin_{};
-    Rectd hitbox_;
+    // Position, rotation, origin and hitbox are kept in Transforms, at the
+    // entity's slot: in its world's store once listed, or in
+    // Transforms::unlisted() by handle index
+    Transforms* transforms_;
+    std::uint32_t slot_;
+    Transforms::Block* transform_;
+    std::uint32_t transformIndex_;
     int layer_{};
     bool removed_{false};
+    bool parallel_{false};
+    bool asleep_{false};
+    bool scheduled_{false};               // Not simply updated every tick
+    bool due_{false};                     // If scheduled_, whether to update
     observing_ptr<World> world_{nullptr}; // Set by parent World
-
-    std::vector<std::string> types_;
+    std::size_t worldIndex_{0};           // Position in world_'s entity list
+    std::size_t layerIndex_{0};           // Position in world_'s draw order
+    SpatialHash<Entity>::Cells cells_;    // Where world_ has it hashed
+    bool boundsChanged_{false};           // Since it was last hashed
+    std::size_t sweepIndex_{0};           // Position in world_'s x-sorted list
+    bool collisionEvents_{false};
+    UpdatePolicy updatePolicy_;
+    std::uint64_t lastUpdate_{0};         // world_'s tick when last updated
+    unsigned elapsedTicks_{1};
+    std::size_t contactCount_{0};         // Pairs in world_'s contact list
+    std::size_t scriptCount_{0};          // Scripts it owns in world_
+    const EntityHandle handle_;
+
+    // Most entities have one type, so spawning them mustn't allocate: the
+    // list of names is shared through TypeTag::single() until a second type
+    // is added, and the ids and type list positions are kept in place
+    std::vector<std::string> const* types_{&ownTypes_};
+    std::vector<std::string> ownTypes_;
+    SmallVector<std::size_t, 2> typeIds_;   // TypeTag ids of *types_
+    SmallVector<std::size_t, 2> typeSlots_; // Positions in world_'s type lists
+    TypeTag::Mask typeMask_{0};
     std::vector<std::unique_ptr<Graphic>> graphics_;
     std::vector<std::unique_ptr<EventHandler::Connection>> connections_;
 
     static int numEnts_;
     const int actorID_;
 
+    // Lets the graphics of an entity that the world culls keep time
+    void skipDraw();
+
+    // Copies the transform to slot in another store, or elsewhere in this
+    // one, and keeps it there from now on
+    void moveTransform(Transforms& to, std::uint32_t slot);
+
+    friend class World;
+    friend class ScriptScheduler;
+
 public:
     /*!
      * \brief Constructs an entity at position pos
@@ -74,32 +177,97 @@ public:
     {
     }
 
+    /*!
+     * \brief Run the part of the entity's per-frame logic that can be done
+     * at the same time as other entities'
+     *
+     * If the entity has been marked with setParallel(), World calls this on a
+     * worker thread at the start of each tick, before calling update() on any
+     * entity. Many entities' parallelUpdate() run at once, so it must only
+     * read the rest of the world and write to the entity's own members: work
+     * out what to do here, and do it in update().
+     *
+     * In particular, it must not move, create, remove or change the types or
+     * layers of any entity (including this one), connect to or fire events,
+     * or emit or subscribe to events on the world's bus (World::emit()),
+     * which isn't locked.
+     *
+     * \see World::setParallel()
+     */
+    virtual void parallelUpdate()
+    {
+    }
+
     /*!
      * \brief Render the entity
      *
-     * Render the entity for the current frame
+     * Render the entity for the current frame, between its position at the
+     * start of the last tick and its current position.
+     *
      * \param cam The camera to draw relative to
+     * \see getAlpha()
+     * \see resetInterpolation()
      */
-    virtual void draw(Camera const&);
+    virtual void draw(Camera const& cam);
+
+    /*!
+     * \brief Returns the smallest rectangle containing everything draw()
+     * draws, in world coordinates
+     *
+     * World doesn't draw entities whose draw bounds are outside the camera's
+     * view. By default they cover the entity's visible graphics, and an
+     * entity with no graphics at all is always drawn. An entity that draws
+     * anything else should override this.
+     *
+     * \see World::setCulling()
+     */
+    virtual Rectd getDrawBounds() const;
 
     /*!
      * \brief Check for collisions with the entity (deprecated?)
      *
-     * Render the entity for the current frame
+     * Finds every other entity in the world's entity list with at least one
+     * type whose hitbox overlaps or touches this one's. Only entities sharing
+     * a cell of the world's spatial hash are tested.
+     *
      * \param type The type of entity with which to detect collisions (defaults
      *        to all)
      * \return A list of all colliding entitities of type.
      * \see setType()
      */
     std::vector<observing_ptr<Entity>>
-            collide(std::vector<std::string> types =
-                            std::vector<std::string>{});
+            collide(std::vector<std::string> const& types =
+                            std::vector<std::string>{})
+    {
+        return types.empty() ? collide(TypeTag::allTypes)
+                             : collide(TypeTag::query(types));
+    }
 
-    std::vector<observing_ptr<Entity>> collide(std::string type)
+    std::vector<observing_ptr<Entity>> collide(std::string const& type)
     {
-        return collide(std::vector<std::string>{type});
+        return collide(TypeTag::query(type));
     }
 
+    /*!
+     * \brief Check for collisions with entities of any of a set of types
+     *
+     * As collide(), but filtering by a mask built with TypeTag::mask(), which
+     * can be kept rather than looking the type names up on every call.
+     *
+     * \param types The types to detect collisions with, or TypeTag::allTypes
+     * \return A list of all colliding entities with one of types.
+     */
+    std::vector<observing_ptr<Entity>> collide(TypeTag::Mask types)
+    {
+        return collide(TypeTag::Query{types, {}});
+    }
+
+    /*!
+     * \brief Check for collisions with entities of any of a set of types,
+     * looked up with TypeTag::query()
+     */
+    std::vector<observing_ptr<Entity>> collide(TypeTag::Query const& types);
+
     /*!
      * \brief Returns the entity's vector position
      *
@@ -107,7 +275,7 @@ public:
      */
     Vectorf const& getPos() const
     {
-        return pos_;
+        return transform_->pos[transformIndex_];
     }
 
     /*!
@@ -117,7 +285,7 @@ public:
      */
     float getRotation() const
     {
-        return rot_;
+        return transform_->rot[transformIndex_];
     }
 
     /*!
@@ -134,7 +302,51 @@ public:
 
     Vectorf const& getOrigin() const
     {
-        return origin_;
+        return transform_->origin[transformIndex_];
+    }
+
+    /*!
+     * \brief Returns how far to draw the entity between its positions at the
+     * start and end of the last tick
+     *
+     * \return World.getAlpha(), or 1 if the entity isn't in a world
+     */
+    float getAlpha() const;
+
+    /*!
+     * \brief Returns the position at which the entity should be drawn
+     *
+     * \param alpha How far to interpolate from the position at the start of
+     *        the last tick to the current position, from 0 to 1
+     * \return Interpolated position
+     */
+    Vectorf getInterpolatedPos(float alpha) const
+    {
+        Vectorf const& pos = transform_->pos[transformIndex_];
+        Vectorf const& lastPos = transform_->lastPos[transformIndex_];
+        return lastPos + (pos - lastPos) * alpha;
+    }
+
+    /*!
+     * \brief Returns the rotation at which the entity should be drawn
+     *
+     * \param alpha How far to interpolate from the rotation at the start of
+     *        the last tick to the current rotation, from 0 to 1
+     * \return Interpolated rotation in degrees
+     */
+    float getInterpolatedRotation(float alpha) const;
+
+    /*!
+     * \brief Stops the entity being drawn between its previous and current
+     * positions until the next tick.
+     *
+     * World calls this before each update. Call it yourself after teleporting
+     * an entity, so that it doesn't appear to slide to its new position.
+     */
+    void resetInterpolation()
+    {
+        transform_->lastPos[transformIndex_] = transform_->pos[transformIndex_];
+        transform_->lastRot[transformIndex_] = transform_->rot[transformIndex_];
     }
 
     /*!
@@ -148,12 +360,24 @@ public:
      */
     Rectd const& getHitbox() const
     {
-        return hitbox_;
+        return transform_->hitbox[transformIndex_];
+    }
+
+    /*!
+     * \brief Returns the entity's hitbox offset by its position
+     *
+     * \return Entity's hitbox in world coordinates
+     */
+    Rectd getWorldHitbox() const
+    {
+        Rectd const& hitbox = transform_->hitbox[transformIndex_];
+        Vectorf const& pos = transform_->pos[transformIndex_];
+        return {hitbox.x + pos.x, hitbox.y + pos.y, hitbox.w, hitbox.h};
     }
 
     std::string getType(unsigned i = 0) const
     {
-        return types_[i];
+        return (*types_)[i];
     }
     /*!
      * \brief Returns the entity's types
@@ -162,12 +386,36 @@ public:
      */
     std::vector<std::string> const& getTypes() const
     {
-        return types_;
+        return *types_;
+    }
+
+    /*!
+     * \brief Returns the entity's types as a mask of TypeTag ids
+     */
+    TypeTag::Mask getTypeMask() const
+    {
+        return typeMask_;
+    }
+
+    bool isType(std::string const& type) const
+    {
+        return isType(TypeTag::query(type));
     }
 
-    bool isType(std::string type) const
+    /*!
+     * \return `true` if the entity has any of the queried types.
+     */
+    bool isType(TypeTag::Query const& types) const
+    {
+        return types.matches(typeMask_, typeIds_);
+    }
+
+    /*!
+     * \return `true` if the entity has any of types.
+     */
+    bool isType(TypeTag::Mask types) const
     {
-        return std::find(types_.begin(), types_.end(), type) != types_.end();
+        return (typeMask_ & types) != 0;
     }
 
     /*!
@@ -213,6 +461,31 @@ public:
         return world_;
     }
 
+    /*!
+     * \brief Returns a handle to the entity
+     *
+     * The handle can be kept for as long as you like, and tells you when the
+     * entity has been destroyed.
+     *
+     * \see EntityHandle
+     */
+    EntityHandle getHandle() const
+    {
+        return handle_;
+    }
+
+    /*!
+     * \brief Returns the entity's slot in Transforms
+     *
+     * Once the entity is listed in a world, this is its place in the
+     * world's entity list and its slot in World.getTransforms(). It changes
+     * as entities before it are removed, and when it changes world.
+     */
+    std::uint32_t getSlot() const
+    {
+        return slot_;
+    }
+
     /*!
      * \brief Returns the entity's unique id (deprecated)
      *
@@ -233,6 +506,9 @@ public:
     /*!
      * \brief Moves the entity pixel by pixel while cond is false
      *
+     * This checks cond twice per pixel moved. To stop at other entities,
+     * moveAndSlide() does the same with a single query.
+     *
      * \param displacement Vectorial distance to move entity
      * \param cond Condition to stop movement (e.g. not
      *collide("solid").empty())
@@ -243,6 +519,87 @@ public:
 
     virtual void moveBy(Vectorf displacement);
 
+    /*!
+     * \brief Finds the first entity of the given types the entity would hit
+     * moving by displacement, without moving it
+     *
+     * The hitbox is swept along the whole displacement in one query of the
+     * world's spatial hash, so nothing is skipped however fast the entity
+     * moves. Entities whose hitboxes already overlap this one's are ignored,
+     * so an entity that has got stuck can move out.
+     *
+     * \param displacement How far to move
+     * \param types The types of entity that block movement, from
+     *        TypeTag::mask(), or TypeTag::allTypes
+     * \return The time of the first hit, the side hit and what's left of
+     *         displacement after it
+     * \see moveAndSlide()
+     */
+    SweepResult sweep(Vectorf displacement, TypeTag::Mask types)
+    {
+        return sweep(displacement, TypeTag::Query{types, {}});
+    }
+
+    SweepResult sweep(Vectorf displacement, std::string const& type)
+    {
+        return sweep(displacement, TypeTag::query(type));
+    }
+
+    SweepResult sweep(Vectorf displacement, TypeTag::Query const& types);
+
+    /*!
+     * \brief Moves the entity, stopping at entities of the given types and
+     * sliding along them
+     *
+     * The entity moves until it would hit something, then carries on with
+     * the part of the remaining displacement along the surface it hit:
+     *
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+     *     auto result = moveAndSlide(velocity_, "solid");
+     *     if (result.hit and result.normal.y < 0) {
+     *         grounded_ = true;
+     *     }
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *
+     * \param displacement How far to move
+     * \param types The types of entity that block movement
+     * \param maxSlides How many surfaces to slide along before giving up
+     * \return Whether anything was hit, and the last surface hit. `time` is
+     *         the fraction of displacement moved before the first hit, and
+     *         `remaining` what wasn't moved after maxSlides slides.
+     * \see sweep()
+     */
+    SweepResult moveAndSlide(Vectorf displacement, TypeTag::Mask types,
+                             unsigned maxSlides = 4)
+    {
+        return moveAndSlide(displacement, TypeTag::Query{types, {}},
+                            maxSlides);
+    }
+
+    SweepResult moveAndSlide(Vectorf displacement, std::string const& type,
+                             unsigned maxSlides = 4)
+    {
+        return moveAndSlide(displacement, TypeTag::query(type), maxSlides);
+    }
+
+    SweepResult moveAndSlide(Vectorf displacement,
+                             TypeTag::Query const& types,
+                             unsigned maxSlides = 4);
+
+    /*!
+     * \brief Moves the entity through tile terrain, stopping at solid tiles
+     *
+     * The hitbox moves horizontally and then vertically, each as far as it
+     * can go, and only the tiles it passes over are looked at. Other
+     * entities don't block it.
+     *
+     * \param terrain The terrain to move through
+     * \param displacement How far to move
+     * \return How far the entity moved, and whether it hit the ground, the
+     *         ceiling or a wall
+     */
+    TerrainMove moveAgainst(Terrain const& terrain, Vectorf displacement);
+
     virtual void setOrigin(Vectorf origin);
     /*!
      * \brief Sets the entity's rotation
@@ -263,6 +620,7 @@ public:
      * types)
      *
      * \param type The type to add
+     * \see TypeTag
      */
     void setType(std::string type);
 
@@ -276,6 +634,9 @@ public:
     /*!
      * \brief Sets the entity's z-layer
      *
+     * Entities on lower layers are drawn first. An entity moved to a new
+     * layer is drawn after the entities already on it.
+     *
      * \param layer The new layer
      */
     void setLayer(int layer);
@@ -328,6 +689,131 @@ public:
         return removed_;
     }
 
+    /*!
+     * \brief Sets whether World should call parallelUpdate() on the entity
+     *
+     * \param parallel `true` to opt in to the two-phase update
+     */
+    void setParallel(bool parallel)
+    {
+        parallel_ = parallel;
+    }
+
+    /*!
+     * \return if World calls parallelUpdate() on the entity.
+     */
+    bool isParallel() const
+    {
+        return parallel_;
+    }
+
+    /*!
+     * \brief Sets how often World calls update() and parallelUpdate()
+     *
+     * Entities updating every few ticks are spread over the ticks between,
+     * rather than all updating together. An entity with a radius is only
+     * updated while it is that close to the middle of the camera's view, or
+     * to an entity passed to World::addFocus(); while further out it is
+     * frozen, and getElapsedTicks() doesn't count the time.
+     *
+     * \see getElapsedTicks()
+     */
+    void setUpdatePolicy(UpdatePolicy policy);
+
+    UpdatePolicy getUpdatePolicy() const
+    {
+        return updatePolicy_;
+    }
+
+    /*!
+     * \brief Stops World updating the entity until wake() is called
+     *
+     * A sleeping entity is still drawn and collided with. It wakes by itself
+     * when its hitbox starts touching another entity's and either of them
+     * has collision events, or when one of its connections fires.
+     */
+    void sleep()
+    {
+        asleep_ = true;
+        scheduled_ = true;
+    }
+
+    /*!
+     * \brief Has World update the entity again, from the next tick
+     */
+    void wake();
+
+    bool isAsleep() const
+    {
+        return asleep_;
+    }
+
+    /*!
+     * \brief Returns the number of ticks since the last update, for entities
+     * updated less than every tick
+     *
+     * Time spent asleep or out of range of the focus points isn't counted,
+     * so this is 1 for an entity updated every tick, and at most the
+     * policy's interval otherwise.
+     */
+    unsigned getElapsedTicks() const
+    {
+        return elapsedTicks_;
+    }
+
+    /*!
+     * \brief Returns getElapsedTicks() in seconds, at Game::fps ticks a
+     * second
+     */
+    float getElapsedTime() const;
+
+    /*!
+     * \brief Sets whether World calls onCollisionBegin() and
+     * onCollisionEnd() on the entity
+     *
+     * Off by default, in which case the entity costs nothing extra. World
+     * works out which entities overlap once a tick, after calling update()
+     * on each, so tracking many entities is much cheaper than calling
+     * collide() from each of them.
+     *
+     * \param enabled `true` to have collision events fired
+     * \see World::forEachOverlappingPair()
+     */
+    void setCollisionEvents(bool enabled);
+
+    /*!
+     * \return if World fires collision events on the entity.
+     */
+    bool hasCollisionEvents() const
+    {
+        return collisionEvents_;
+    }
+
+    /*!
+     * \brief Called when another entity starts to overlap this one
+     *
+     * Only called if setCollisionEvents() is on. As with collide(), only
+     * entities in the same world with at least one type count.
+     *
+     * \param other The entity now overlapping this one
+     */
+    virtual void onCollisionBegin(Entity& other)
+    {
+    }
+
+    /*!
+     * \brief Called when an entity that overlapped this one no longer does
+     *
+     * This is also called when either entity leaves the world, before
+     * onRemoved(). Every onCollisionBegin() is followed by an
+     * onCollisionEnd(), even if collision events have since been turned off.
+     *
+     * \param other The entity that overlapped this one
+     */
+    virtual void onCollisionEnd(Entity& other)
+    {
+    }
+
     /*!
      * \brief Called when the entitiy is added to a World
      */
@@ -344,6 +830,9 @@ public:
 
     /*!
      * \brief Determine if entity is off the screen.
+     *
+     * Compares getDrawBounds() with what the world's camera shows.
+     *
      * \return If the entitiy is _fully_ off the screen.
      */
     virtual bool offScreen() const;
@@ -356,6 +845,11 @@ public:
 
     virtual bool partOffScreen() const;
 
+private:
+    // What the world's camera shows, or the screen outside a world
+    Rectd screenBounds() const;
+
+public:
     /*!
      * \brief For the event handler, determine if given entity is off the
      * screen.
@@ -393,6 +887,19 @@ public:
      */
     virtual ~Entity();
 
+    /*!
+     * \brief Allocates entities from EntityPool
+     */
+    static void* operator new(std::size_t size)
+    {
+        return EntityPool::allocate(size);
+    }
+
+    static void operator delete(void* p, std::size_t size)
+    {
+        EntityPool::deallocate(p, size);
+    }
+
     tank::observing_ptr<tank::EventHandler::Connection>
             connect(tank::EventHandler::Condition condition,
                     tank::EventHandler::Effect effect);
@@ -0,0 +1,57 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "EntityHandle.hpp"
+
+#include <algorithm>
+
+namespace tank
+{
+
+constexpr std::uint32_t EntityHandle::nullIndex;
+EntityHandle::Slot* EntityHandle::slots_ = nullptr;
+std::uint32_t EntityHandle::size_ = 0;
+std::uint32_t EntityHandle::capacity_ = 0;
+std::uint32_t EntityHandle::firstFree_ = EntityHandle::nullIndex;
+
+EntityHandle EntityHandle::acquire(Entity* entity)
+{
+    EntityHandle handle;
+
+    if (firstFree_ != nullIndex) {
+        handle.index_ = firstFree_;
+        firstFree_ = slots_[firstFree_].nextFree;
+    } else {
+        if (size_ == capacity_) {
+            const std::uint32_t capacity = std::max<std::uint32_t>(
+                    1024, capacity_ * 2);
+            Slot* slots = new Slot[capacity];
+            std::copy(slots_, slots_ + size_, slots);
+            delete[] slots_;
+            slots_ = slots;
+            capacity_ = capacity;
+        }
+
+        handle.index_ = size_++;
+        slots_[handle.index_].generation = 0;
+    }
+
+    Slot& slot = slots_[handle.index_];
+    slot.entity = entity;
+    slot.nextFree = nullIndex;
+    handle.generation_ = slot.generation;
+    return handle;
+}
+
+void EntityHandle::release(EntityHandle handle)
+{
+    Slot& slot = slots_[handle.index_];
+    slot.entity = nullptr;
+    ++slot.generation;
+    slot.nextFree = firstFree_;
+    firstFree_ = handle.index_;
+}
+
+} // tank
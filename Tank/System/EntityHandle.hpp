@@ -0,0 +1,209 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_ENTITYHANDLE_HPP
+#define TANK_ENTITYHANDLE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include "../Utility/observing_ptr.hpp"
+
+namespace tank
+{
+
+class Entity;
+
+/*!
+ * \brief A reference to an Entity that knows when the entity is gone.
+ *
+ * Every Entity takes a slot in a global table when it is constructed, and
+ * gives it back when it is destroyed. A handle is the index of that slot,
+ * plus the generation the slot was on when the entity took it: each time a
+ * slot is given back its generation goes up, so handles to the old entity no
+ * longer match. Checking a handle is a single array lookup.
+ *
+ * Unlike an observing_ptr, a handle can be kept after its entity has been
+ * deleted: get() just returns `nullptr`. Handles stay valid when an entity
+ * moves between worlds.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     tank::Handle<Enemy> target = world->makeEntity<Enemy>(pos);
+ *     // ... some ticks later
+ *     if (target) {
+ *         aimAt(target->getPos());
+ *     }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The table isn't locked, so entities should only be created, destroyed or
+ * looked up through handles on the main thread.
+ *
+ * \see Handle
+ * \see World::makeEntity()
+ */
+class EntityHandle
+{
+    friend class Entity;
+
+    struct Slot
+    {
+        Entity* entity;
+        std::uint32_t generation;
+        std::uint32_t nextFree;
+    };
+
+    // Plain pointers rather than a vector, so that the table is never
+    // destroyed before entities owned by other static objects
+    static Slot* slots_;
+    static std::uint32_t size_;
+    static std::uint32_t capacity_;
+    static std::uint32_t firstFree_;
+
+    std::uint32_t index_;
+    std::uint32_t generation_;
+
+public:
+    /*! \brief Index of a handle that refers to no entity */
+    static constexpr std::uint32_t nullIndex = UINT32_MAX;
+
+    /*!
+     * \brief Creates a handle that refers to no entity
+     */
+    EntityHandle() : index_(nullIndex), generation_(0)
+    {
+    }
+
+    /*!
+     * \brief Returns the entity, or `nullptr` if it has been destroyed
+     */
+    Entity* get() const
+    {
+        if (index_ < size_ and slots_[index_].generation == generation_) {
+            return slots_[index_].entity;
+        }
+        return nullptr;
+    }
+
+    /*!
+     * \return `true` if the entity hasn't been destroyed.
+     */
+    bool isValid() const
+    {
+        return get() != nullptr;
+    }
+
+    explicit operator bool() const
+    {
+        return isValid();
+    }
+
+    /*!
+     * \brief Accesses the entity
+     *
+     * \throws std::runtime_error if the entity has been destroyed
+     */
+    Entity* operator->() const
+    {
+        return &**this;
+    }
+
+    Entity& operator*() const
+    {
+        Entity* entity = get();
+        if (not entity) {
+            throw std::runtime_error("Entity handle is stale");
+        }
+        return *entity;
+    }
+
+    operator observing_ptr<Entity>() const
+    {
+        return get();
+    }
+
+    std::uint32_t index() const
+    {
+        return index_;
+    }
+
+    std::uint32_t generation() const
+    {
+        return generation_;
+    }
+
+    bool operator==(EntityHandle const& other) const
+    {
+        return index_ == other.index_ and generation_ == other.generation_;
+    }
+
+    bool operator!=(EntityHandle const& other) const
+    {
+        return not (*this == other);
+    }
+
+private:
+    static EntityHandle acquire(Entity* entity);
+    static void release(EntityHandle handle);
+};
+
+/*!
+ * \brief An EntityHandle to an entity of type T
+ *
+ * Returned by World::makeEntity(). Converts to an observing_ptr<T>, so it can
+ * be passed to anything that takes one.
+ */
+template <typename T>
+class Handle : public EntityHandle
+{
+public:
+    Handle() = default;
+
+    /*!
+     * \brief Treats a handle as referring to a T
+     *
+     * The entity isn't checked: it must be a T.
+     */
+    explicit Handle(EntityHandle handle) : EntityHandle(handle)
+    {
+    }
+
+    T* get() const
+    {
+        return static_cast<T*>(EntityHandle::get());
+    }
+
+    T* operator->() const
+    {
+        return &**this;
+    }
+
+    T& operator*() const
+    {
+        return static_cast<T&>(EntityHandle::operator*());
+    }
+
+    template <typename U>
+    operator observing_ptr<U>() const
+    {
+        return observing_ptr<U>(get());
+    }
+};
+
+} // tank
+
+namespace std
+{
+template <>
+struct hash<tank::EntityHandle>
+{
+    size_t operator()(tank::EntityHandle const& handle) const
+    {
+        return std::hash<std::uint64_t>()(
+                (std::uint64_t{handle.generation()} << 32) | handle.index());
+    }
+};
+}
+
+#endif /* TANK_ENTITYHANDLE_HPP */
@@ -0,0 +1,86 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "EntityPool.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace tank
+{
+
+constexpr std::size_t EntityPool::granularity;
+constexpr std::size_t EntityPool::maxSize;
+constexpr std::size_t EntityPool::chunkSlots;
+EntityPool::SizeClass EntityPool::classes_[maxSize / granularity];
+
+void* EntityPool::allocate(std::size_t size)
+{
+    if (size > maxSize) {
+        return ::operator new(size);
+    }
+
+    SizeClass& sizeClass = classes_[classOf(size)];
+    if (not sizeClass.free) {
+        const std::size_t slotSize = (classOf(size) + 1) * granularity;
+        char* chunk = static_cast<char*>(::operator new(slotSize * chunkSlots));
+
+        // Thread the new slots onto the free list, first slot first
+        for (std::size_t i = chunkSlots; i-- > 0;) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + i * slotSize);
+            slot->next = sizeClass.free;
+            sizeClass.free = slot;
+        }
+        sizeClass.capacity += chunkSlots;
+    }
+
+    FreeSlot* slot = sizeClass.free;
+    sizeClass.free = slot->next;
+    ++sizeClass.live;
+    sizeClass.highWater = std::max(sizeClass.highWater, sizeClass.live);
+    return slot;
+}
+
+void EntityPool::deallocate(void* p, std::size_t size)
+{
+    if (not p) {
+        return;
+    }
+
+    if (size > maxSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    SizeClass& sizeClass = classes_[classOf(size)];
+    FreeSlot* slot = static_cast<FreeSlot*>(p);
+    slot->next = sizeClass.free;
+    sizeClass.free = slot;
+    --sizeClass.live;
+}
+
+EntityPool::Stats EntityPool::stats(std::size_t size)
+{
+    if (size > maxSize) {
+        return {0, 0, 0, 0};
+    }
+
+    SizeClass const& sizeClass = classes_[classOf(size)];
+    return {(classOf(size) + 1) * granularity, sizeClass.live,
+            sizeClass.highWater, sizeClass.capacity};
+}
+
+std::vector<EntityPool::Stats> EntityPool::allStats()
+{
+    std::vector<Stats> result;
+    for (std::size_t i = 0; i < maxSize / granularity; ++i) {
+        if (classes_[i].capacity > 0) {
+            result.push_back(stats((i + 1) * granularity));
+        }
+    }
+    return result;
+}
+
+} // tank
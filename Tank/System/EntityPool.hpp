@@ -0,0 +1,123 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_ENTITYPOOL_HPP
+#define TANK_ENTITYPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace tank
+{
+
+/*!
+ * \brief The memory every Entity is allocated from.
+ *
+ * Entity overrides `operator new` and `operator delete` to use this, so
+ * every entity, whether made by World::makeEntity() or with `new`, comes
+ * from here. Sizes are rounded up to a multiple of granularity, and each of
+ * these size classes keeps a free list of slots, carved out of chunks of
+ * chunkSlots slots. A destroyed entity's slot goes back on its free list for
+ * the next entity of that size, so once a game has reached its peak number
+ * of entities, spawning more makes no calls to the global allocator.
+ * Entities larger than maxSize use the global allocator, as does giving an
+ * entity a second type with Entity.addType().
+ *
+ * Chunks are never given back, so the memory used is set by the most
+ * entities of each size alive at once. stats() reports this.
+ *
+ * Like the handle table, the pool isn't locked: entities should only be
+ * created and destroyed on the main thread.
+ */
+class EntityPool
+{
+public:
+    /*! \brief Sizes are rounded up to a multiple of this */
+    static constexpr std::size_t granularity = 16;
+    /*! \brief Larger entities aren't pooled */
+    static constexpr std::size_t maxSize = 2048;
+    /*! \brief How many slots each chunk is split into */
+    static constexpr std::size_t chunkSlots = 64;
+
+    /*!
+     * \brief Usage of one size class
+     */
+    struct Stats
+    {
+        /*! \brief The size of a slot, in bytes */
+        std::size_t slotSize;
+        /*! \brief Slots in use */
+        std::size_t live;
+        /*! \brief The most slots that have been in use at once */
+        std::size_t highWater;
+        /*! \brief Slots allocated, in use or free */
+        std::size_t capacity;
+    };
+
+private:
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    struct SizeClass
+    {
+        FreeSlot* free;
+        std::size_t live;
+        std::size_t highWater;
+        std::size_t capacity;
+    };
+
+    // Plain static data, never destroyed, so entities owned by static
+    // objects can still be freed at exit
+    static SizeClass classes_[maxSize / granularity];
+
+public:
+    /*!
+     * \brief Returns memory for an object of size bytes
+     *
+     * \throws std::bad_alloc if the global allocator fails
+     */
+    static void* allocate(std::size_t size);
+
+    /*!
+     * \brief Gives back memory from allocate()
+     *
+     * \param p The memory
+     * \param size The size it was allocated with
+     */
+    static void deallocate(void* p, std::size_t size);
+
+    /*!
+     * \brief Returns the usage of the size class objects of size bytes use
+     *
+     * For sizes larger than maxSize, all fields are 0.
+     */
+    static Stats stats(std::size_t size);
+
+    /*!
+     * \brief Returns the usage of the size class entities of type T use
+     */
+    template <typename T>
+    static Stats statsFor()
+    {
+        return stats(sizeof(T));
+    }
+
+    /*!
+     * \brief Returns the usage of every size class that has been used
+     */
+    static std::vector<Stats> allStats();
+
+private:
+    static std::size_t classOf(std::size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+};
+
+} // tank
+
+#endif /* TANK_ENTITYPOOL_HPP */
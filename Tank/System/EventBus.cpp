@@ -0,0 +1,70 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "EventBus.hpp"
+
+namespace tank
+{
+
+std::size_t EventBus::nextChannelIndex()
+{
+    static std::size_t next = 0;
+    return next++;
+}
+
+void EventBus::deliver()
+{
+    // Events emitted by handlers wait for the next call
+    if (delivering_ or queued_.empty()) {
+        return;
+    }
+
+    batches_.swap(queued_);
+    for (Channel* channel : batches_) {
+        channel->take();
+    }
+
+    delivering_ = true;
+    try {
+        for (Channel* channel : batches_) {
+            channel->deliver();
+        }
+    } catch (...) {
+        finishDelivery();
+        throw;
+    }
+    finishDelivery();
+}
+
+void EventBus::finishDelivery()
+{
+    delivering_ = false;
+    for (Channel* channel : batches_) {
+        channel->finish();
+    }
+    batches_.clear();
+}
+
+void EventBus::clear()
+{
+    for (auto& channel : channels_) {
+        if (channel) {
+            channel->clear();
+        }
+    }
+    queued_.clear();
+}
+
+void EventBus::unsubscribe(std::size_t channel, std::uint64_t id)
+{
+    channels_[channel]->unsubscribe(id);
+}
+
+bool EventBus::isSubscribed(std::size_t channel, std::uint64_t id) const
+{
+    return channels_[channel]->isSubscribed(id);
+}
+
+} // tank
@@ -0,0 +1,360 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_EVENTBUS_HPP
+#define TANK_EVENTBUS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tank
+{
+
+/*!
+ * \brief Queues events of any type, and hands them to the functions
+ * subscribed to that type in one batch
+ *
+ * Each event type has its own contiguous queue. emit() appends to it, and
+ * deliver() calls every handler subscribed to the type with each event, in
+ * the order they were emitted. Handlers of one type are called before those
+ * of the next, types going in the order they were first emitted since the
+ * last deliver(). Nothing is done for types with no events, so a bus with
+ * thousands of subscribers costs nothing in a frame where nothing happens.
+ *
+ * Events emitted and subscriptions made by a handler wait for the next
+ * deliver(). Unsubscribing from a handler takes effect straight away.
+ *
+ * The bus isn't locked, so may only be used from one thread.
+ *
+ * \see World.emit()
+ * \see World.subscribe()
+ */
+class EventBus
+{
+public:
+    class Subscription;
+
+    template <typename T>
+    using Handler = std::function<void(T const&)>;
+
+private:
+    class Channel
+    {
+    public:
+        bool queued {false};
+        // Between take() and finish()
+        bool delivering {false};
+
+        virtual ~Channel() = default;
+
+        // Moves the queued events to the batch being delivered
+        virtual void take() = 0;
+        virtual void deliver() = 0;
+        // Clears the batch and adds subscriptions made while delivering
+        virtual void finish() = 0;
+        virtual void unsubscribe(std::uint64_t id) = 0;
+        virtual bool isSubscribed(std::uint64_t id) const = 0;
+        virtual void clear() = 0;
+    };
+
+    template <typename T>
+    class TypedChannel;
+
+    // Indexed by channelIndex<T>()
+    std::vector<std::unique_ptr<Channel>> channels_;
+    // Channels with events, in the order they were first emitted to
+    std::vector<Channel*> queued_;
+    std::vector<Channel*> batches_;
+    bool delivering_ {false};
+    std::uint64_t nextId_ {1};
+
+    static std::size_t nextChannelIndex();
+
+    template <typename T>
+    static std::size_t channelIndex()
+    {
+        static const std::size_t index = nextChannelIndex();
+        return index;
+    }
+
+    template <typename T>
+    TypedChannel<T>& channel();
+
+    void finishDelivery();
+    void unsubscribe(std::size_t channel, std::uint64_t id);
+    bool isSubscribed(std::size_t channel, std::uint64_t id) const;
+
+public:
+    /*!
+     * \brief Queues an event for the functions subscribed to its type
+     */
+    template <typename T>
+    void emit(T event);
+
+    /*!
+     * \brief Calls handler with each event of type T, until the returned
+     * Subscription is destroyed
+     *
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+     *     struct Died { tank::EntityHandle entity; };
+     *
+     *     score_ = bus.subscribe<Died>([this](Died const&) { ++kills_; });
+     *     // ... elsewhere
+     *     bus.emit(Died{getHandle()});
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     */
+    template <typename T>
+    Subscription subscribe(Handler<T> handler);
+
+    /*!
+     * \brief Hands every queued event to the handlers subscribed to its
+     * type
+     *
+     * If a handler throws, the rest of the batch is dropped.
+     */
+    void deliver();
+
+    /*!
+     * \brief Drops queued events and all subscriptions
+     *
+     * Mustn't be called from a handler.
+     */
+    void clear();
+
+    EventBus() = default;
+    EventBus(EventBus const&) = delete;
+    EventBus& operator=(EventBus const&) = delete;
+};
+
+template <typename T>
+class EventBus::TypedChannel : public EventBus::Channel
+{
+    struct Listener
+    {
+        std::uint64_t id;
+        Handler<T> handler;
+        bool live;
+    };
+
+    std::vector<T> queue_;
+    std::vector<T> batch_;
+    // Sorted on id, as ids only grow
+    std::vector<Listener> listeners_;
+    std::vector<Listener> pending_;
+    bool dead_ {false};
+
+    static bool idLess(Listener const& l, std::uint64_t id)
+    {
+        return l.id < id;
+    }
+
+    typename std::vector<Listener>::const_iterator find(std::uint64_t id) const
+    {
+        auto found = std::lower_bound(listeners_.begin(), listeners_.end(),
+                                      id, idLess);
+        if (found != listeners_.end() and found->id == id) {
+            return found;
+        }
+        return listeners_.end();
+    }
+
+public:
+    void push(T event)
+    {
+        queue_.push_back(std::move(event));
+    }
+
+    void subscribe(std::uint64_t id, Handler<T> handler)
+    {
+        (delivering ? pending_ : listeners_)
+                .push_back({id, std::move(handler), true});
+    }
+
+    void take() override
+    {
+        queued = false;
+        delivering = true;
+        batch_.swap(queue_);
+    }
+
+    void deliver() override
+    {
+        // Listeners only grow in finish(), so the size can't change here
+        for (T const& event : batch_) {
+            for (Listener const& listener : listeners_) {
+                if (listener.live) {
+                    listener.handler(event);
+                }
+            }
+        }
+    }
+
+    void finish() override
+    {
+        delivering = false;
+        batch_.clear();
+        if (dead_) {
+            listeners_.erase(std::remove_if(listeners_.begin(),
+                                            listeners_.end(),
+                                            [](Listener const& l) {
+                                                return not l.live;
+                                            }),
+                             listeners_.end());
+            dead_ = false;
+        }
+        for (Listener& listener : pending_) {
+            listeners_.push_back(std::move(listener));
+        }
+        pending_.clear();
+    }
+
+    void unsubscribe(std::uint64_t id) override
+    {
+        auto pending = std::find_if(
+                pending_.begin(), pending_.end(),
+                [id](Listener const& l) { return l.id == id; });
+        if (pending != pending_.end()) {
+            pending_.erase(pending);
+            return;
+        }
+
+        auto found = find(id);
+        if (found == listeners_.end()) {
+            return;
+        }
+        auto i = listeners_.begin() + (found - listeners_.cbegin());
+        if (delivering) {
+            // The handler may be the one running, so is only destroyed in
+            // finish()
+            i->live = false;
+            dead_ = true;
+        } else {
+            listeners_.erase(i);
+        }
+    }
+
+    bool isSubscribed(std::uint64_t id) const override
+    {
+        auto found = find(id);
+        if (found != listeners_.end()) {
+            return found->live;
+        }
+        return std::any_of(pending_.begin(), pending_.end(),
+                           [id](Listener const& l) { return l.id == id; });
+    }
+
+    void clear() override
+    {
+        queue_.clear();
+        batch_.clear();
+        listeners_.clear();
+        pending_.clear();
+        dead_ = false;
+        queued = false;
+    }
+};
+
+/*!
+ * \brief Keeps a function subscribed to an EventBus, unsubscribing it when
+ * destroyed
+ *
+ * Subscriptions can be moved but not copied, and mustn't outlive their bus.
+ * A default-constructed subscription isn't subscribed to anything.
+ */
+class EventBus::Subscription
+{
+    friend class EventBus;
+
+    EventBus* bus_ {nullptr};
+    std::size_t channel_ {0};
+    std::uint64_t id_ {0};
+
+    Subscription(EventBus& bus, std::size_t channel, std::uint64_t id)
+            : bus_(&bus), channel_(channel), id_(id)
+    {
+    }
+
+public:
+    Subscription() = default;
+
+    Subscription(Subscription&& other) noexcept
+            : bus_(other.bus_), channel_(other.channel_), id_(other.id_)
+    {
+        other.bus_ = nullptr;
+    }
+
+    Subscription& operator=(Subscription&& other) noexcept
+    {
+        if (this != &other) {
+            unsubscribe();
+            bus_ = other.bus_;
+            channel_ = other.channel_;
+            id_ = other.id_;
+            other.bus_ = nullptr;
+        }
+        return *this;
+    }
+
+    Subscription(Subscription const&) = delete;
+    Subscription& operator=(Subscription const&) = delete;
+
+    ~Subscription()
+    {
+        unsubscribe();
+    }
+
+    void unsubscribe()
+    {
+        if (bus_) {
+            bus_->unsubscribe(channel_, id_);
+            bus_ = nullptr;
+        }
+    }
+
+    bool isSubscribed() const
+    {
+        return bus_ and bus_->isSubscribed(channel_, id_);
+    }
+};
+
+template <typename T>
+EventBus::TypedChannel<T>& EventBus::channel()
+{
+    const std::size_t index = channelIndex<T>();
+    if (index >= channels_.size()) {
+        channels_.resize(index + 1);
+    }
+    if (not channels_[index]) {
+        channels_[index].reset(new TypedChannel<T>);
+    }
+    return static_cast<TypedChannel<T>&>(*channels_[index]);
+}
+
+template <typename T>
+void EventBus::emit(T event)
+{
+    TypedChannel<T>& c = channel<T>();
+    c.push(std::move(event));
+    if (not c.queued) {
+        c.queued = true;
+        queued_.push_back(&c);
+    }
+}
+
+template <typename T>
+EventBus::Subscription EventBus::subscribe(Handler<T> handler)
+{
+    const std::uint64_t id = nextId_++;
+    channel<T>().subscribe(id, std::move(handler));
+    return {*this, channelIndex<T>(), id};
+}
+
+} // tank
+
+#endif /* TANK_EVENTBUS_HPP */
@@ -4,30 +4,233 @@
 //  http://www.boost.org/LICENSE_1_0.txt)
 
 #include "EventHandler.hpp"
+#include <algorithm>
 #include <numeric>
+#include "../Utility/Profiler.hpp"
 
 namespace tank
 {
-std::size_t EventHandler::ConnectedPair::counter = 0;
+void EventHandler::Condition::normalize(std::vector<InputSource>& sources)
+{
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+}
 
 void EventHandler::propagate()
 {
-    for (auto& x : connections) {
-        if (x.condition()) {
-            x.effect();
+    TANK_PROFILE_ZONE("EventHandler::propagate");
+    compact();
+
+    // Input conditions are checked in the frame their inputs change, and the
+    // frame after (when presses and releases compare against the last
+    // state), and for as long as they hold
+    due_.clear();
+    for (auto const* list : {&woken_, &recheck_, &active_}) {
+        for (std::uint32_t slot : *list) {
+            Slot const& s = slots_[slot];
+            if (s.used and s.table == Table::Input) {
+                due_.push_back(s.position);
+            }
+        }
+    }
+    std::sort(due_.begin(), due_.end());
+    due_.erase(std::unique(due_.begin(), due_.end()), due_.end());
+
+    recheck_.swap(woken_);
+    woken_.clear();
+    active_.clear();
+    ++frame_;
+
+    // Nothing moves until finishPropagate(): connections made by effects wait
+    // in pending_, and disconnected ones are only marked dead
+    propagating_ = true;
+    try {
+        // Walk both tables in the order they were connected
+        std::size_t polled = 0;
+        auto next = due_.begin();
+        while (polled < polled_.size() or next != due_.end()) {
+            if (next == due_.end() or
+                (polled < polled_.size() and
+                 polled_[polled].order < input_[*next].order)) {
+                Entry const& x = polled_[polled++];
+                if (x.live and x.condition()) {
+                    x.effect();
+                }
+                continue;
+            }
+
+            Entry const& x = input_[*next++];
+            if (x.live and x.condition()) {
+                active_.push_back(x.slot);
+                x.effect();
+            }
         }
+    } catch (...) {
+        finishPropagate();
+        throw;
     }
+    finishPropagate();
 }
 
-std::unique_ptr<EventHandler::Connection>
-        EventHandler::connect(Condition condition, Effect effect)
+void EventHandler::wake(InputSource source)
 {
-    auto iter = this->connections.emplace(condition, effect);
-    return std::unique_ptr<Connection>(new Connection{*this, iter.first});
+    auto found = listeners_.find(source.getId());
+    if (found == listeners_.end() or found->second.wokenFrame == frame_) {
+        return;
+    }
+
+    found->second.wokenFrame = frame_;
+    woken_.insert(woken_.end(), found->second.slots.begin(),
+                  found->second.slots.end());
+}
+
+void EventHandler::wakeAll()
+{
+    for (Entry const& x : input_) {
+        if (x.live) {
+            woken_.push_back(x.slot);
+        }
+    }
+}
+
+std::size_t EventHandler::size() const
+{
+    std::size_t pending = 0;
+    for (Entry const& x : pending_) {
+        pending += x.live;
+    }
+    return polled_.size() + input_.size() - tombstones_ + pending;
+}
+
+EventHandler::Connection EventHandler::connect(Condition condition,
+                                               Effect effect)
+{
+    std::uint32_t slot;
+    if (freeSlots_.empty()) {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back({0, 0, Table::Polled, false});
+    } else {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+    slots_[slot].used = true;
+
+    for (InputSource source : condition.getSources()) {
+        listeners_[source.getId()].slots.push_back(slot);
+    }
+    if (not condition.getSources().empty()) {
+        // Checked once straight away, in case it already holds
+        woken_.push_back(slot);
+    }
+
+    add({std::move(condition), std::move(effect), order_++, slot, true});
+    return {*this, slot, slots_[slot].generation};
+}
+
+std::vector<EventHandler::Entry>& EventHandler::table(Table table)
+{
+    switch (table) {
+    case Table::Polled:
+        return polled_;
+    case Table::Input:
+        return input_;
+    default:
+        return pending_;
+    }
+}
+
+void EventHandler::add(Entry entry)
+{
+    Table t = Table::Pending;
+    if (not propagating_) {
+        t = entry.condition.getSources().empty() ? Table::Polled
+                                                 : Table::Input;
+    }
+
+    std::vector<Entry>& entries = table(t);
+    slots_[entry.slot].table = t;
+    slots_[entry.slot].position = static_cast<std::uint32_t>(entries.size());
+    entries.push_back(std::move(entry));
+}
+
+void EventHandler::compact()
+{
+    if (tombstones_ == 0) {
+        return;
+    }
+
+    for (auto* entries : {&polled_, &input_}) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < entries->size(); ++i) {
+            Entry& x = (*entries)[i];
+            if (not x.live) {
+                continue;
+            }
+            if (kept != i) {
+                (*entries)[kept] = std::move(x);
+            }
+            slots_[(*entries)[kept].slot].position =
+                    static_cast<std::uint32_t>(kept);
+            ++kept;
+        }
+        entries->erase(entries->begin() + kept, entries->end());
+    }
+    tombstones_ = 0;
+}
+
+void EventHandler::finishPropagate()
+{
+    propagating_ = false;
+
+    // pending_ is swapped out, as add() won't put anything back in it now
+    std::vector<Entry> pending;
+    pending.swap(pending_);
+    for (Entry& x : pending) {
+        if (x.live) {
+            add(std::move(x));
+        }
+    }
+    pending.clear();
+    pending_.swap(pending);
+}
+
+void EventHandler::disconnect(std::uint32_t slot, std::uint32_t generation)
+{
+    if (not isConnected(slot, generation)) {
+        return;
+    }
+
+    Slot& s = slots_[slot];
+    Entry& x = table(s.table)[s.position];
+    x.live = false;
+    if (s.table != Table::Pending) {
+        ++tombstones_;
+    }
+
+    for (InputSource source : x.condition.getSources()) {
+        auto found = listeners_.find(source.getId());
+        auto& slots = found->second.slots;
+        slots.erase(std::find(slots.begin(), slots.end(), slot));
+        if (slots.empty()) {
+            listeners_.erase(found);
+        }
+    }
+
+    s.used = false;
+    ++s.generation;
+    freeSlots_.push_back(slot);
+
+    // Keep tombstones from piling up when nothing propagates
+    if (not propagating_ and
+        tombstones_ * 2 > polled_.size() + input_.size()) {
+        compact();
+    }
 }
 
-void EventHandler::disconnect(Connection& connection)
+bool EventHandler::isConnected(std::uint32_t slot,
+                               std::uint32_t generation) const
 {
-    connections.erase(connection.getIterator());
+    return slot < slots_.size() and slots_[slot].used and
+           slots_[slot].generation == generation;
 }
 }
@@ -6,10 +6,15 @@
 #ifndef TANK_EVENTS_HPP
 #define TANK_EVENTS_HPP
 
-#include <memory>
-#include <set>
+#include <cstdint>
 #include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 #include <SFML/Window/Event.hpp>
+#include "Conditions.hpp"
+#include "InputSource.hpp"
+#include "../Utility/InplaceFunction.hpp"
 
 namespace tank
 {
@@ -24,6 +29,12 @@ namespace tank
  * Events are registered using EventHandler.connect(), and triggered by
  * EventHandler.propagate().
  *
+ * Conditions made by Keyboard, Mouse and Controller (and combinations of
+ * them) know which inputs they read. Those are only checked when Game wakes
+ * one of their inputs, in the frame after, and for as long as they hold, so
+ * thousands of key bindings cost nothing while their keys are left alone.
+ * Any other condition is checked on every propagate().
+ *
  * \see Keyboard
  * \see Mouse
  * \see Controller
@@ -32,37 +43,58 @@ class EventHandler
 {
 public:
     class Connection;
+    class Condition;
 
-    using Condition = std::function<bool()>;
     using Effect = std::function<void()>;
 
 private:
-    class ConnectedPair
-    {
-        static std::size_t counter;
-        std::size_t uid;
+    struct Entry;
 
-    public:
-        Condition condition;
-        Effect effect;
+    enum class Table : std::uint8_t { Polled, Input, Pending };
 
-        ConnectedPair(Condition condition, Effect effect)
-                : uid{counter}, condition{condition}, effect{effect}
-        {
-            ++counter;
-        }
+    // Where a connection's entry is. Connections refer to slots, which stay
+    // put while entries move.
+    struct Slot
+    {
+        std::uint32_t position;
+        std::uint32_t generation;
+        Table table;
+        bool used;
+    };
 
-        // std::set boilerplate
-        bool operator<(const ConnectedPair& rhs) const
-        {
-            return this->uid < rhs.uid;
-        }
+    struct Listeners
+    {
+        std::vector<std::uint32_t> slots;
+        std::size_t wokenFrame;
     };
 
-    using ConnectedPairList = std::set<ConnectedPair>;
-    ConnectedPairList connections;
+    // Entries are packed in the order they were connected. Disconnecting
+    // leaves a tombstone, swept out at the start of the next propagate().
+    std::vector<Entry> polled_;  // Checked every propagate()
+    std::vector<Entry> input_;   // Checked when woken
+    std::vector<Entry> pending_; // Connected during propagate()
+    std::size_t tombstones_ {0};
+    std::uint64_t order_ {0};
+    bool propagating_ {false};
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> freeSlots_;
 
-    void disconnect(Connection& connection);
+    std::unordered_map<std::uint32_t, Listeners> listeners_;
+    std::size_t frame_ {1};
+    // Slots of input connections to check: those whose inputs changed this
+    // frame or last, and those that held last frame
+    std::vector<std::uint32_t> woken_;
+    std::vector<std::uint32_t> recheck_;
+    std::vector<std::uint32_t> active_;
+    std::vector<std::uint32_t> due_;
+
+    std::vector<Entry>& table(Table table);
+    void add(Entry entry);
+    void compact();
+    void finishPropagate();
+    void disconnect(std::uint32_t slot, std::uint32_t generation);
+    bool isConnected(std::uint32_t slot, std::uint32_t generation) const;
 
 public:
     // FIXME: "connect" isn't really a good name for this function. Something
@@ -83,12 +115,16 @@ public:
      * event when it is destroyed. Thefore, you must store connections that you
      * want to persist.
      *
+     * Connecting and disconnecting from inside an effect is safe: new events
+     * are first checked in the next propagate(), and disconnected events
+     * aren't triggered again, even later in the same propagate().
+     *
      * Example:
      *
      * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
      * class MyEnt : public tank::Entity
      * {
-     *     std::unique_ptr<tank::EventHandler::Connection> a,b,c;
+     *     tank::EventHandler::Connection a,b,c;
      *
      * public:
      *     // Must manage connections in onAdded, as getWorld() is not set at
@@ -137,76 +173,197 @@ public:
      * \param effect A void function object which will be called when condition
      * returns true
      */
-    std::unique_ptr<Connection> connect(Condition condition, Effect effect);
+    Connection connect(Condition condition, Effect effect);
 
     /*!
      * \brief Check registered events, triggering each effect if its condition
      * returns true.
      *
+     * Effects are triggered in the order they were connected. Conditions that
+     * read inputs are only checked when woken (see wake()) or while they hold.
+     * The rest are checked in one pass over a packed array.
+     *
      * On the event handler of the active World, this is called every frame
      * before World::update() and World::draw() -- therefore, you should not
      * need to call it yourself.
      */
     void propagate();
 
+    /*!
+     * \brief Marks an input as changed, so that conditions reading it are
+     * checked in the next two propagate() calls
+     *
+     * Game calls this for every input event before propagate().
+     */
+    void wake(InputSource source);
+
+    /*!
+     * \brief Has every condition checked in the next propagate()
+     *
+     * For when input has changed without this handler being told, such as
+     * while its world wasn't the active one.
+     */
+    void wakeAll();
+
+    /*! \brief Returns the number of connected events */
+    std::size_t size() const;
+
     EventHandler() = default;
     EventHandler(EventHandler const&) = delete;
     EventHandler& operator=(EventHandler const&) = delete;
 };
 
-class EventHandler::Connection
+/*!
+ * \brief A function returning whether an event should fire, and the inputs
+ * it reads, if any
+ *
+ * Any function object returning bool converts to a Condition that is checked
+ * every frame. Keyboard, Mouse and Controller make condition expressions that
+ * list their inputs; combining those with `&&`, `||` and fnot() keeps the
+ * inputs, while combining them with anything else gives a condition checked
+ * every frame.
+ *
+ * The function object is stored inside the Condition when it fits, so
+ * connecting a combination of expressions doesn't allocate it.
+ *
+ * Listed inputs are a promise: the condition's value may only change when one
+ * of them is passed to EventHandler.wake(), or in the frame after.
+ *
+ * \see ConditionExpression
+ */
+class EventHandler::Condition : public ConditionExpression
 {
-    EventHandler& events;
-    ConnectedPairList::iterator iterator;
-    bool connected = true;
+    std::vector<InputSource> sources_;
+    InplaceFunction<bool()> test_;
+
+    template <typename F>
+    static std::vector<InputSource> sourcesOf(F const& test, std::true_type)
+    {
+        std::vector<InputSource> sources;
+        if (test.isIndexed()) {
+            test.appendSources(sources);
+            normalize(sources);
+        }
+        return sources;
+    }
+
+    template <typename F>
+    static std::vector<InputSource> sourcesOf(F const&, std::false_type)
+    {
+        return {};
+    }
+
+    static void normalize(std::vector<InputSource>& sources);
 
 public:
-    Connection(EventHandler& events, ConnectedPairList::iterator iterator)
-            : events(events), iterator(iterator)
+    template <typename F,
+              typename = typename std::enable_if<
+                      not std::is_same<typename std::decay<F>::type,
+                                       Condition>::value and
+                      std::is_convertible<F, std::function<bool()>>::value>::
+                      type>
+    Condition(F test)
+            : sources_(sourcesOf(test, IsCondition<F>{})),
+              test_(std::move(test))
     {
     }
 
-    ~Connection()
+    bool operator()() const
     {
-        disconnect();
+        return test_();
     }
 
-    void disconnect()
+    /*! \brief Returns the inputs read, or none if checked every frame */
+    std::vector<InputSource> const& getSources() const
     {
-        if (not connected) {
-            return;
-        } // REVIEW: This will never happen
-        connected = false;
-        events.disconnect(*this);
+        return sources_;
     }
 
-    ConnectedPairList::iterator getIterator()
+    bool isIndexed() const
     {
-        return iterator;
+        return not sources_.empty();
     }
 
-    bool isConnected() const
+    void appendSources(std::vector<InputSource>& sources) const
     {
-        return connected;
+        sources.insert(sources.end(), sources_.begin(), sources_.end());
     }
 };
 
-inline std::function<bool()> fnot(std::function<bool()> f)
+struct EventHandler::Entry
 {
-    return [f]() { return !f(); };
-}
-}
+    Condition condition;
+    Effect effect;
+    std::uint64_t order;
+    std::uint32_t slot;
+    bool live;
+};
 
-inline std::function<bool()> operator&&(std::function<bool()> f1,
-                                        std::function<bool()> f2)
+/*!
+ * \brief Keeps an event connected to an EventHandler, disconnecting it when
+ * destroyed
+ *
+ * Connections can be moved but not copied. A default-constructed connection
+ * isn't connected to anything.
+ */
+class EventHandler::Connection
 {
-    return [f1, f2]() { return f1() && f2(); };
-}
+    friend class EventHandler;
+
+    EventHandler* events_ {nullptr};
+    std::uint32_t slot_ {0};
+    std::uint32_t generation_ {0};
+
+    Connection(EventHandler& events, std::uint32_t slot,
+               std::uint32_t generation)
+            : events_(&events), slot_(slot), generation_(generation)
+    {
+    }
+
+public:
+    Connection() = default;
+
+    Connection(Connection&& other) noexcept
+            : events_(other.events_), slot_(other.slot_),
+              generation_(other.generation_)
+    {
+        other.events_ = nullptr;
+    }
+
+    Connection& operator=(Connection&& other) noexcept
+    {
+        if (this != &other) {
+            disconnect();
+            events_ = other.events_;
+            slot_ = other.slot_;
+            generation_ = other.generation_;
+            other.events_ = nullptr;
+        }
+        return *this;
+    }
+
+    Connection(Connection const&) = delete;
+    Connection& operator=(Connection const&) = delete;
+
+    ~Connection()
+    {
+        disconnect();
+    }
+
+    void disconnect()
+    {
+        if (events_) {
+            events_->disconnect(slot_, generation_);
+            events_ = nullptr;
+        }
+    }
+
+    bool isConnected() const
+    {
+        return events_ and events_->isConnected(slot_, generation_);
+    }
+};
 
-inline std::function<bool()> operator||(std::function<bool()> f1,
-                                        std::function<bool()> f2)
-{
-    return [f1, f2]() { return f1() || f2(); };
 }
 
 #endif // TANK_EVENTS_HPP
@@ -5,6 +5,7 @@
 
 #include "Game.hpp"
 
+#include <algorithm>
 #include <iterator>
 #include <SFML/Window/Event.hpp>
 #include <SFML/System/Utf.hpp>
@@ -12,22 +13,31 @@
 #include "Keyboard.hpp"
 #include "Mouse.hpp"
 #include "Window.hpp"
+#include "../Utility/Profiler.hpp"
 
 namespace tank
 {
 
 Logger Game::log{"log.txt"};
 std::stringstream Game::keystream;
-// TODO: allow variable framerate
 unsigned int Game::fps {60};
+bool Game::fixedTimestep {true};
+unsigned int Game::maxTicksPerFrame {5};
+unsigned int Game::inputSampleRate {0};
 bool Game::initialized_ {false};
+bool Game::headless_ {false};
 bool Game::run_ {false};
 bool Game::popWorld_ {false};
 observing_ptr<World> Game::currentWorld_ {nullptr};
 std::unique_ptr<Window> Game::window_ {nullptr};
 std::stack<std::unique_ptr<World>> Game::worlds_;
 std::unique_ptr<World> Game::newWorld_ {nullptr};
-// Timer Game::frameTimer_;
+Vectoru Game::screenSize_ {};
+std::size_t Game::ticks_ {0};
+std::size_t Game::tickLimit_ {0};
+InputQueue Game::input_;
+std::vector<InputSource> Game::toggled_;
+Timer Game::frameTimer_;
 
 /* ---------------------------- *
  * Initialization
@@ -45,26 +55,62 @@ bool Game::initialize(Vectoru wSize, int fps)
         // Initialize controllers (should happen after Window)
         Controllers::initialize();
 
-        // TODO: Make this reflect actual FPS
         Game::fps = fps;
     }
 
     return initialized_;
 }
 
+bool Game::initializeHeadless(Vectoru screenSize, int fps)
+{
+    if (not initialized_) {
+        initialized_ = true;
+        headless_ = true;
+
+        log << "Running headless" << std::endl;
+        screenSize_ = screenSize;
+        Game::fps = fps;
+    }
+
+    return initialized_;
+}
+
+Vectoru Game::screenSize()
+{
+    if (window_) {
+        return window_->getSize();
+    }
+    return screenSize_;
+}
+
 /* ----------------------------------- *
  * Main Game Loop
  * ----------------------------------- */
 
-void Game::run()
+void Game::run(std::size_t ticks)
 {
     if (run_) {
         return;
     }
 
     run_ = true;
+    ticks_ = 0;
+    tickLimit_ = ticks;
     log << "Entering game loop" << std::endl;
+
+    using Duration = std::chrono::steady_clock::duration;
+    // Start with a full tick so that the first frame isn't drawn un-updated
+    Duration accumulator = std::chrono::seconds(1);
+    accumulator /= fps;
+    Duration lastFrame = Duration::zero();
+    frameTimer_.start();
+
+    if (window_) {
+        input_.startSampling(inputSampleRate);
+    }
+
     while (run_) {
+        TANK_PROFILE_ZONE("Game::frame");
         popWorld_ = false;
         if (newWorld_) {
             log << "Adding game world to stack" << std::endl;
@@ -78,48 +124,136 @@ void Game::run()
         }
 
         currentWorld_ = worlds_.top();
-        handleEvents();
-        currentWorld_->update();
-        draw();
+        pollInput();
+
+        float alpha = 1.f;
+        if (headless_) {
+            update();
+        } else if (fixedTimestep) {
+            Duration tickLength = std::chrono::seconds(1);
+            tickLength /= fps;
+
+            const Duration now = frameTimer_.getDuration();
+            accumulator += now - lastFrame;
+            lastFrame = now;
+
+            // When the first tick would have run, had it run on time
+            const TimePoint firstTick = InputQueue::Clock::now() - accumulator;
+
+            unsigned int ticks = 0;
+            while (accumulator >= tickLength and ticks < maxTicksPerFrame) {
+                accumulator -= tickLength;
+                ++ticks;
+
+                // Each tick takes the input up to its end, and the last
+                // takes the rest
+                if (accumulator >= tickLength and ticks < maxTicksPerFrame) {
+                    update(firstTick + ticks * tickLength);
+                } else {
+                    update();
+                }
+
+                // A world change takes effect next frame, so stop ticking
+                if (not run_ or popWorld_ or newWorld_) {
+                    break;
+                }
+            }
+
+            // Drop whatever backlog we couldn't catch up on
+            accumulator %= tickLength;
+            alpha = static_cast<float>(accumulator.count()) /
+                    tickLength.count();
+        } else {
+            update();
+        }
+
+        if (not headless_) {
+            draw(alpha);
+        }
 
         if (popWorld_) {
             worlds_.pop();
+            // The world underneath missed whatever input came in meanwhile
+            if (not worlds_.empty()) {
+                worlds_.top()->eventHandler.wakeAll();
+            }
         }
+
+        TANK_PROFILE_FRAME();
     }
-    log << "Exiting game loop" << std::endl;
+
+    input_.stopSampling();
+
+    const double seconds =
+            std::chrono::duration<double>(frameTimer_.getDuration()).count();
+    log << "Exiting game loop after " << ticks_ << " ticks in " << seconds
+        << "s (" << ticks_ / seconds << " ticks per second)" << std::endl;
+    if (input_.taken() > 0) {
+        const double latency = std::chrono::duration<double, std::milli>(
+                                       input_.meanLatency())
+                                       .count();
+        log << "Mean input latency " << latency << "ms over "
+            << input_.taken() << " events" << std::endl;
+    }
+
+#ifdef TANK_PROFILE
+    const Profiler::FrameStats stats = Profiler::frameStats();
+    log << "Frame times over the last " << stats.frames << " frames: p50 "
+        << stats.p50 << "ms, p95 " << stats.p95 << "ms, p99 " << stats.p99
+        << "ms, max " << stats.max << "ms" << std::endl;
+#endif
 }
 
-void Game::handleEvents()
+void Game::pollInput()
 {
-    Keyboard::reset();
-    Mouse::reset();
-    Controllers::reset();
-
+    TANK_PROFILE_ZONE("Game::pollInput");
+    // Keys and mouse buttons come from the sampler thread, if it's running
+    const bool sampling = input_.isSampling();
     sf::Event event;
 
-    while (window_->pollEvent(event)) {
+    while (window_ and window_->pollEvent(event)) {
+        InputEvent input {};
+        input.time = InputQueue::Clock::now();
+
         switch (event.type) {
         case sf::Event::KeyPressed:
-            Keyboard::setKeyPressed(event.key.code);
-            break;
         case sf::Event::KeyReleased:
-            if (event.key.code == sf::Keyboard::Key::F4 && event.key.alt) {
+            if (event.type == sf::Event::KeyReleased and
+                event.key.code == sf::Keyboard::Key::F4 && event.key.alt) {
                 run_ = false;
                 break;
             }
-            Keyboard::setKeyReleased(event.key.code);
+            if (sampling or event.key.code < 0 or
+                event.key.code >= sf::Keyboard::KeyCount) {
+                break;
+            }
+            input.type = event.type == sf::Event::KeyPressed
+                                 ? InputEvent::Type::KeyPressed
+                                 : InputEvent::Type::KeyReleased;
+            input.code = static_cast<std::uint16_t>(event.key.code);
+            input_.push(input);
             break;
         case sf::Event::MouseButtonPressed:
-            Mouse::setButtonPressed(event.mouseButton.button);
-            break;
         case sf::Event::MouseButtonReleased:
-            Mouse::setButtonReleased(event.mouseButton.button);
+            if (sampling) {
+                break;
+            }
+            input.type = event.type == sf::Event::MouseButtonPressed
+                                 ? InputEvent::Type::ButtonPressed
+                                 : InputEvent::Type::ButtonReleased;
+            input.code = static_cast<std::uint16_t>(event.mouseButton.button);
+            input_.push(input);
             break;
         case sf::Event::MouseMoved:
-            Mouse::setPos(event.mouseMove.x, event.mouseMove.y);
+            input.type = InputEvent::Type::MouseMoved;
+            input.x = event.mouseMove.x;
+            input.y = event.mouseMove.y;
+            input_.push(input);
             break;
         case sf::Event::MouseWheelMoved:
-            Mouse::setWheelDelta(event.mouseWheel.delta);
+            input.type = InputEvent::Type::WheelMoved;
+            input.x = event.mouseWheel.delta;
+            input_.push(input);
             break;
         case sf::Event::MouseLeft:
             Mouse::setLeft();
@@ -128,23 +262,32 @@ void Game::handleEvents()
             Mouse::setEntered();
             break;
         case sf::Event::JoystickConnected:
-            Controllers::setStatus(event.joystickConnect.joystickId, true);
-            break;
         case sf::Event::JoystickDisconnected:
-            Controllers::setStatus(event.joystickConnect.joystickId, false);
+            input.type = event.type == sf::Event::JoystickConnected
+                                 ? InputEvent::Type::ControllerConnected
+                                 : InputEvent::Type::ControllerDisconnected;
+            input.controller = static_cast<std::uint8_t>(
+                    event.joystickConnect.joystickId);
+            input_.push(input);
             break;
         case sf::Event::JoystickMoved:
-            Controllers::setAxis(event.joystickMove.joystickId,
-                                 event.joystickMove.axis,
-                                 event.joystickMove.position);
+            input.type = InputEvent::Type::ControllerMoved;
+            input.controller =
+                    static_cast<std::uint8_t>(event.joystickMove.joystickId);
+            input.code = static_cast<std::uint16_t>(event.joystickMove.axis);
+            input.position = event.joystickMove.position;
+            input_.push(input);
             break;
         case sf::Event::JoystickButtonPressed:
-            Controllers::setButton(event.joystickButton.joystickId,
-                                   event.joystickButton.button, true);
-            break;
         case sf::Event::JoystickButtonReleased:
-            Controllers::setButton(event.joystickButton.joystickId,
-                                   event.joystickButton.button, false);
+            input.type = event.type == sf::Event::JoystickButtonPressed
+                                 ? InputEvent::Type::ControllerButtonPressed
+                                 : InputEvent::Type::ControllerButtonReleased;
+            input.controller = static_cast<std::uint8_t>(
+                    event.joystickButton.joystickId);
+            input.code =
+                    static_cast<std::uint16_t>(event.joystickButton.button);
+            input_.push(input);
             break;
         case sf::Event::TextEntered:
             // TODO: Replace SFML helpers with <locale>?
@@ -152,8 +295,12 @@ void Game::handleEvents()
             sf::Utf<32>::encodeAnsi(event.text.unicode,
                                     std::ostream_iterator<char>(keystream));
         case sf::Event::GainedFocus:
+            input_.setFocused(true);
             draw();
             break;
+        case sf::Event::LostFocus:
+            input_.setFocused(false);
+            break;
         case sf::Event::Closed:
             run_ = false;
             break;
@@ -162,7 +309,106 @@ void Game::handleEvents()
         }
     }
 
-    currentWorld_->eventHandler.propagate();
+    input_.collect();
+}
+
+void Game::handleEvents(TimePoint deadline)
+{
+    TANK_PROFILE_ZONE("Game::handleEvents");
+    Keyboard::reset();
+    Mouse::reset();
+    Controllers::reset();
+
+    // Input conditions are only checked when their inputs change
+    EventHandler& events = currentWorld_->eventHandler;
+
+    toggled_.clear();
+    while (InputEvent const* event = input_.peek(deadline)) {
+        if (not applyInput(*event, events)) {
+            break;
+        }
+        input_.pop();
+    }
+
+    events.propagate();
+}
+
+bool Game::applyInput(InputEvent const& event, EventHandler& events)
+{
+    using Type = InputEvent::Type;
+    const InputSource source = event.getSource();
+
+    if (event.isToggle()) {
+        bool changes = true;
+        switch (event.type) {
+        case Type::KeyPressed:
+        case Type::KeyReleased:
+            changes = Keyboard::isKeyDown(static_cast<Key>(event.code)) !=
+                      (event.type == Type::KeyPressed);
+            break;
+        case Type::ButtonPressed:
+        case Type::ButtonReleased:
+            changes = Mouse::isButtonDown(
+                              static_cast<Mouse::Button>(event.code)) !=
+                      (event.type == Type::ButtonPressed);
+            break;
+        default:
+            break;
+        }
+
+        // A press and release in one tick would hide each other, so the
+        // second waits for the next tick, and everything after it with it.
+        // Repeated presses of a held key don't count.
+        if (changes) {
+            if (std::find(toggled_.begin(), toggled_.end(), source) !=
+                toggled_.end()) {
+                return false;
+            }
+            toggled_.push_back(source);
+        }
+    }
+
+    switch (event.type) {
+    case Type::KeyPressed:
+        Keyboard::setKeyPressed(static_cast<Key>(event.code));
+        events.wake(InputSource::anyKey());
+        break;
+    case Type::KeyReleased:
+        Keyboard::setKeyReleased(static_cast<Key>(event.code));
+        events.wake(InputSource::anyKey());
+        break;
+    case Type::ButtonPressed:
+        Mouse::setButtonPressed(static_cast<Mouse::Button>(event.code));
+        events.wake(InputSource::anyMouseButton());
+        break;
+    case Type::ButtonReleased:
+        Mouse::setButtonReleased(static_cast<Mouse::Button>(event.code));
+        events.wake(InputSource::anyMouseButton());
+        break;
+    case Type::MouseMoved:
+        Mouse::setPos(event.x, event.y);
+        break;
+    case Type::WheelMoved:
+        // Several wheel events in a tick add up
+        Mouse::setWheelDelta(Mouse::wheelDelta() + event.x);
+        break;
+    case Type::ControllerConnected:
+    case Type::ControllerDisconnected:
+        Controllers::setStatus(event.controller,
+                               event.type == Type::ControllerConnected);
+        break;
+    case Type::ControllerButtonPressed:
+    case Type::ControllerButtonReleased:
+        Controllers::setButton(event.controller, event.code,
+                               event.type == Type::ControllerButtonPressed);
+        break;
+    case Type::ControllerMoved:
+        Controllers::setAxis(event.controller, event.code, event.position);
+        break;
+    }
+
+    events.wake(source);
+    return true;
 }
 
 /* ----------------------------------- *
@@ -178,14 +424,22 @@ void Game::popWorld()
  * Update and draw functions
  * --------------------------- */
 
-void Game::update()
+void Game::update(TimePoint deadline)
 {
+    handleEvents(deadline);
+    currentWorld_->update();
+
+    if (++ticks_ == tickLimit_) {
+        run_ = false;
+    }
 }
 
-void Game::draw()
+void Game::draw(float alpha)
 {
     // Draw current world
+    currentWorld_->alpha_ = alpha;
     currentWorld_->draw();
+    currentWorld_->alpha_ = 1.f;
 
     // Update the screen
     window_->flipDisplay();
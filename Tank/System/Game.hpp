@@ -12,6 +12,7 @@
 #include "../Utility/Timer.hpp"
 #include "../Utility/Logger.hpp"
 #include "../Utility/observing_ptr.hpp"
+#include "InputQueue.hpp"
 #include "Window.hpp"
 #include "World.hpp"
 
@@ -56,6 +57,53 @@ namespace tank
  * Finally, if popWorld() has been called, the active world will be destroyed,
  * and the next frame will begin.
  *
+ * ## Timing
+ *
+ * By default the active world is updated at a fixed rate of Game::fps ticks
+ * per second, independently of how often it is drawn. Each frame, the time
+ * since the last frame is added to an accumulator and the world is ticked
+ * until the accumulator holds less than one tick. If the machine can't keep
+ * up, at most Game::maxTicksPerFrame ticks are run and the rest of the
+ * backlog is dropped, so a slow frame slows the game down rather than
+ * stalling it.
+ *
+ * Whatever is left in the accumulator becomes an interpolation factor
+ * between 0 and 1, returned by World::getAlpha() while the world is drawn, so
+ * that entities can be drawn between their previous and current positions.
+ *
+ * Setting Game::fixedTimestep to `false` restores the old behaviour of
+ * exactly one update per drawn frame.
+ *
+ * ## Input
+ *
+ * Input events are polled from the window once a frame and queued in the
+ * order they happened, each with the time it was received. When a frame runs
+ * several ticks, each tick takes the events up to the time it stands for, and
+ * the last takes the rest. A tick never takes both a press and a release of
+ * the same key or button: the second waits for the next tick, along with
+ * everything after it, so quick taps aren't lost however slow the frame.
+ * Setting Game::inputSampleRate reads the keyboard and mouse buttons on a
+ * separate thread instead, timestamping presses as they happen.
+ *
+ * ## Running without a window
+ *
+ * Game::initializeHeadless() sets up the game without opening a window, for
+ * running simulations on machines with no display (servers, batch jobs and
+ * benchmarks). In headless mode the game loop doesn't draw or wait: it
+ * updates the active world as fast as possible, or for the number of ticks
+ * passed to Game::run(). The tick rate achieved is written to Game::log when
+ * the loop exits.
+ *
+ * Game::window() is null in headless mode. Input is never received, so
+ * Keyboard, Mouse and Controller state stays at rest.
+ *
+ * ## Profiling
+ *
+ * Building with the `PROFILE` CMake option times each phase of the game loop
+ * with Profiler. Frame time percentiles are written to Game::log when the
+ * loop exits, and Profiler::writeChromeTrace() saves a timeline of the
+ * recorded phases.
+ *
  * ##Managing Worlds
  *
  * Tank currently uses a simple stack to manage worlds. In a frame, you
@@ -149,14 +197,43 @@ public:
     static std::stringstream keystream;
 
     /*!
-     * \brief Frame-rate of the game (60)
+     * \brief Update rate of the game in ticks per second (60)
      *
      * \return Value passed to Game::initialize()
      */
     static unsigned int fps;
 
+    /*!
+     * \brief Whether the world is updated at a fixed rate (true)
+     *
+     * If `false`, the world is updated exactly once per drawn frame and the
+     * interpolation factor returned by World::getAlpha() is always 1.
+     */
+    static bool fixedTimestep;
+
+    /*!
+     * \brief Most ticks run to catch up in a single frame (5)
+     */
+    static unsigned int maxTicksPerFrame;
+
+    /*!
+     * \brief How many times a second to read the keyboard and mouse buttons
+     * on a separate thread, or 0 to take them from window events (0)
+     *
+     * Window events are only polled once a frame, so a press is timestamped
+     * up to a frame late. Sampling reads the keys and buttons as they change,
+     * whatever the frame rate, so ticks run to catch up after a slow frame
+     * see presses in the ticks they happened in. Set before Game::run().
+     *
+     * This relies on sf::Keyboard::isKeyPressed() and
+     * sf::Mouse::isButtonPressed() working off the main thread, which isn't
+     * the case on every platform.
+     */
+    static unsigned int inputSampleRate;
+
 private:
     static bool initialized_;
+    static bool headless_;
     static bool run_;
 
     static bool popWorld_;
@@ -167,6 +244,13 @@ private:
     static std::stack<std::unique_ptr<World>> worlds_;
     static Timer frameTimer_;
     static std::unique_ptr<World> newWorld_;
+    static Vectoru screenSize_;
+    static std::size_t ticks_;
+    static std::size_t tickLimit_;
+
+    static InputQueue input_;
+    // Inputs pressed or released in the current tick
+    static std::vector<InputSource> toggled_;
 
 public:
     Game() = delete;
@@ -182,8 +266,22 @@ public:
      */
     static bool initialize(Vectoru windowSize, int fps = 60);
 
-    /*! \brief Starts the game loop */
-    static void run();
+    /*!
+     * \brief Initializes the game without a Window
+     *
+     * \param screenSize The size of the screen to assume when positioning
+     *        cameras and checking whether entities are on screen.
+     * \return `true` on success.
+     */
+    static bool initializeHeadless(Vectoru screenSize = {800, 600},
+                                   int fps = 60);
+
+    /*!
+     * \brief Starts the game loop
+     *
+     * \param ticks If not 0, the loop stops after updating this many times.
+     */
+    static void run(std::size_t ticks = 0);
 
     /*!
      * \brief Removes the current World at the end of the frame.
@@ -231,12 +329,29 @@ public:
         return currentWorld_;
     }
 
-    /*! \brief Returns a `const unique_ptr&` to the Window. */
+    /*!
+     * \brief Returns a `const unique_ptr&` to the Window.
+     *
+     * This is null before initialization and in headless mode.
+     */
     static std::unique_ptr<Window> const& window()
     {
         return window_;
     };
 
+    /*! \brief Returns whether the game was initialized without a Window */
+    static bool isHeadless()
+    {
+        return headless_;
+    }
+
+    /*!
+     * \brief Returns the size of the screen in pixels
+     *
+     * This is the Window size, or the size passed to initializeHeadless().
+     */
+    static Vectoru screenSize();
+
     /*!
      * \brief Stops the game loop
      *
@@ -258,9 +373,13 @@ public:
     }
 
 private:
-    static void handleEvents();
-    static void update();
-    static void draw();
+    using TimePoint = InputQueue::Clock::time_point;
+
+    static void pollInput();
+    static void handleEvents(TimePoint deadline);
+    static bool applyInput(InputEvent const& event, EventHandler& events);
+    static void update(TimePoint deadline = TimePoint::max());
+    static void draw(float alpha = 1.f);
 };
 
 template <typename T, typename... Args>
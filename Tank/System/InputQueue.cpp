@@ -0,0 +1,160 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "InputQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Window/Mouse.hpp>
+
+namespace tank
+{
+
+InputSource InputEvent::getSource() const
+{
+    switch (type) {
+    case Type::KeyPressed:
+    case Type::KeyReleased:
+        return InputSource::key(code);
+    case Type::ButtonPressed:
+    case Type::ButtonReleased:
+        return InputSource::mouseButton(code);
+    case Type::MouseMoved:
+        return InputSource::mouseMove();
+    case Type::WheelMoved:
+        return InputSource::mouseWheel();
+    case Type::ControllerConnected:
+    case Type::ControllerDisconnected:
+        return InputSource::controllerConnection(controller);
+    case Type::ControllerButtonPressed:
+    case Type::ControllerButtonReleased:
+        return InputSource::controllerButton(controller, code);
+    default:
+        return InputSource::controllerAxis(controller, code);
+    }
+}
+
+bool InputEvent::isToggle() const
+{
+    switch (type) {
+    case Type::MouseMoved:
+    case Type::WheelMoved:
+    case Type::ControllerMoved:
+        return false;
+    default:
+        return true;
+    }
+}
+
+InputQueue::~InputQueue()
+{
+    stopSampling();
+}
+
+void InputQueue::startSampling(unsigned int rate)
+{
+    if (sampling_ or rate == 0) {
+        return;
+    }
+
+    sampling_ = true;
+    const Clock::duration period =
+            std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::seconds(1)) /
+            rate;
+    sampler_ = std::thread([this, period] { sample(period); });
+}
+
+void InputQueue::stopSampling()
+{
+    sampling_ = false;
+    if (sampler_.joinable()) {
+        sampler_.join();
+    }
+}
+
+void InputQueue::sample(Clock::duration period)
+{
+    // Starts from nothing held, as Keyboard and Mouse do
+    std::array<bool, sf::Keyboard::KeyCount> keys {};
+    std::array<bool, sf::Mouse::ButtonCount> buttons {};
+
+    InputEvent event {};
+    Clock::time_point next = Clock::now();
+    while (sampling_.load(std::memory_order_relaxed)) {
+        if (focused_.load(std::memory_order_relaxed)) {
+            event.time = Clock::now();
+
+            // A change that doesn't fit is tried again next sample
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                const auto key = static_cast<sf::Keyboard::Key>(i);
+                const bool down = sf::Keyboard::isKeyPressed(key);
+                if (down != keys[i]) {
+                    event.type = down ? InputEvent::Type::KeyPressed
+                                      : InputEvent::Type::KeyReleased;
+                    event.code = static_cast<std::uint16_t>(i);
+                    if (sampled_.push(event)) {
+                        keys[i] = down;
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < buttons.size(); ++i) {
+                const auto button = static_cast<sf::Mouse::Button>(i);
+                const bool down = sf::Mouse::isButtonPressed(button);
+                if (down != buttons[i]) {
+                    event.type = down ? InputEvent::Type::ButtonPressed
+                                      : InputEvent::Type::ButtonReleased;
+                    event.code = static_cast<std::uint16_t>(i);
+                    if (sampled_.push(event)) {
+                        buttons[i] = down;
+                    }
+                }
+            }
+        }
+
+        // Don't try to catch up on samples missed while descheduled
+        next = std::max(next + period, Clock::now());
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void InputQueue::collect()
+{
+    events_.erase(events_.begin(), events_.begin() + next_);
+    next_ = 0;
+
+    // Window events were stamped when polled, so sampled events can be older
+    const std::size_t polled = events_.size();
+    InputEvent event;
+    while (sampled_.pop(event)) {
+        events_.push_back(event);
+    }
+    if (polled != 0 and polled != events_.size()) {
+        std::stable_sort(events_.begin(), events_.end(),
+                         [](InputEvent const& a, InputEvent const& b) {
+                             return a.time < b.time;
+                         });
+    }
+}
+
+void InputQueue::pop()
+{
+    latency_ += Clock::now() - events_[next_].time;
+    ++taken_;
+    ++next_;
+}
+
+void InputQueue::clear()
+{
+    events_.clear();
+    next_ = 0;
+    InputEvent event;
+    while (sampled_.pop(event)) {
+    }
+}
+
+} // tank
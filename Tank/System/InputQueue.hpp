@@ -0,0 +1,181 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_INPUTQUEUE_HPP
+#define TANK_INPUTQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "InputSource.hpp"
+#include "../Utility/RingBuffer.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief A change to an input, and when it happened
+ */
+struct InputEvent
+{
+    using Clock = std::chrono::steady_clock;
+
+    enum class Type : std::uint8_t {
+        KeyPressed,
+        KeyReleased,
+        ButtonPressed,
+        ButtonReleased,
+        MouseMoved,
+        WheelMoved,
+        ControllerConnected,
+        ControllerDisconnected,
+        ControllerButtonPressed,
+        ControllerButtonReleased,
+        ControllerMoved
+    };
+
+    Clock::time_point time;
+    Type type;
+    std::uint8_t controller;
+    // Key, button or axis
+    std::uint16_t code;
+    // Mouse position or wheel delta in x
+    std::int32_t x, y;
+    float position;
+
+    /*! \brief Returns the input changed */
+    InputSource getSource() const;
+
+    /*!
+     * \brief Returns whether two changes to the input in one tick would hide
+     * each other, as a press and release would
+     */
+    bool isToggle() const;
+};
+
+/*!
+ * \brief Holds input events in the order they happened, until the game
+ * ticks that consume them
+ *
+ * Game pushes the events it polls from the window each frame. Optionally, a
+ * sampler thread also reads the keyboard and mouse buttons many times a
+ * frame, passing what changed through a lock-free RingBuffer, so that those
+ * events are timestamped when they happen rather than when the frame polls
+ * for them.
+ *
+ * Each tick takes the events up to the time it stands for. A tick never
+ * takes a press and release of the same input, so a tap shorter than a tick
+ * is still seen by the tick after, rather than lost.
+ *
+ * \see Game::inputSampleRate
+ */
+class InputQueue
+{
+public:
+    using Clock = InputEvent::Clock;
+
+private:
+    // Filled by the sampler thread
+    RingBuffer<InputEvent, 1024> sampled_;
+    std::thread sampler_;
+    std::atomic<bool> sampling_ {false};
+    std::atomic<bool> focused_ {true};
+
+    // Events in time order; those before next_ have been taken
+    std::vector<InputEvent> events_;
+    std::size_t next_ {0};
+
+    Clock::duration latency_ {};
+    std::size_t taken_ {0};
+
+    void sample(Clock::duration period);
+
+public:
+    InputQueue() = default;
+    InputQueue(InputQueue const&) = delete;
+    InputQueue& operator=(InputQueue const&) = delete;
+    ~InputQueue();
+
+    /*!
+     * \brief Starts reading the keyboard and mouse buttons on another thread
+     *
+     * \param rate Samples per second
+     */
+    void startSampling(unsigned int rate);
+
+    /*! \brief Stops and joins the sampler thread, if running */
+    void stopSampling();
+
+    /*!
+     * \brief Returns whether the keyboard and mouse buttons are being
+     * sampled, and so shouldn't also be pushed from window events
+     */
+    bool isSampling() const
+    {
+        return sampling_.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Tells the sampler whether the window has focus; input isn't
+     * sampled while it doesn't
+     */
+    void setFocused(bool focused)
+    {
+        focused_.store(focused, std::memory_order_relaxed);
+    }
+
+    /*! \brief Adds an event, from the main thread */
+    void push(InputEvent const& event)
+    {
+        events_.push_back(event);
+    }
+
+    /*!
+     * \brief Moves events from the sampler thread in with the rest, in time
+     * order
+     *
+     * Called once a frame, after polling the window.
+     */
+    void collect();
+
+    /*!
+     * \brief Returns the next event that happened no later than deadline,
+     * or null
+     */
+    InputEvent const* peek(Clock::time_point deadline) const
+    {
+        if (next_ == events_.size() or events_[next_].time > deadline) {
+            return nullptr;
+        }
+        return &events_[next_];
+    }
+
+    /*! \brief Takes the event returned by peek() */
+    void pop();
+
+    /*! \brief Drops every event not yet taken */
+    void clear();
+
+    /*!
+     * \brief Returns the mean time from events happening to being taken
+     */
+    Clock::duration meanLatency() const
+    {
+        return taken_ ? latency_ / static_cast<Clock::rep>(taken_)
+                      : Clock::duration::zero();
+    }
+
+    /*! \brief Returns the number of events taken */
+    std::size_t taken() const
+    {
+        return taken_;
+    }
+};
+
+} // tank
+
+#endif /* TANK_INPUTQUEUE_HPP */
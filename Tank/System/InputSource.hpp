@@ -0,0 +1,114 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_INPUTSOURCE_HPP
+#define TANK_INPUTSOURCE_HPP
+
+#include <cstdint>
+
+namespace tank
+{
+
+/*!
+ * \brief Identifies one input that an EventHandler::Condition depends on
+ *
+ * Conditions made by Keyboard, Mouse and Controller list the inputs they
+ * read, and Game wakes those conditions only when one of their inputs
+ * changes, instead of checking them every frame.
+ *
+ * \see EventHandler
+ */
+class InputSource
+{
+public:
+    enum class Kind : std::uint8_t {
+        Key,
+        AnyKey,
+        MouseButton,
+        AnyMouseButton,
+        MouseMove,
+        MouseWheel,
+        ControllerButton,
+        ControllerAxis,
+        ControllerConnection
+    };
+
+private:
+    // Kind in the top byte, controller in the next, then the key, button or
+    // axis
+    std::uint32_t id_;
+
+    InputSource(Kind kind, unsigned device, unsigned code)
+            : id_(static_cast<std::uint32_t>(kind) << 24 |
+                  (device & 0xFF) << 16 | (code & 0xFFFF))
+    {
+    }
+
+public:
+    static InputSource key(int key)
+    {
+        return {Kind::Key, 0, static_cast<unsigned>(key)};
+    }
+    static InputSource anyKey()
+    {
+        return {Kind::AnyKey, 0, 0};
+    }
+    static InputSource mouseButton(int button)
+    {
+        return {Kind::MouseButton, 0, static_cast<unsigned>(button)};
+    }
+    static InputSource anyMouseButton()
+    {
+        return {Kind::AnyMouseButton, 0, 0};
+    }
+    static InputSource mouseMove()
+    {
+        return {Kind::MouseMove, 0, 0};
+    }
+    static InputSource mouseWheel()
+    {
+        return {Kind::MouseWheel, 0, 0};
+    }
+    static InputSource controllerButton(unsigned controller, unsigned button)
+    {
+        return {Kind::ControllerButton, controller, button};
+    }
+    static InputSource controllerAxis(unsigned controller, unsigned axis)
+    {
+        return {Kind::ControllerAxis, controller, axis};
+    }
+    static InputSource controllerConnection(unsigned controller)
+    {
+        return {Kind::ControllerConnection, controller, 0};
+    }
+
+    Kind getKind() const
+    {
+        return static_cast<Kind>(id_ >> 24);
+    }
+
+    /*! \brief Returns a number unique to this input */
+    std::uint32_t getId() const
+    {
+        return id_;
+    }
+
+    bool operator==(InputSource const& rhs) const
+    {
+        return id_ == rhs.id_;
+    }
+    bool operator!=(InputSource const& rhs) const
+    {
+        return id_ != rhs.id_;
+    }
+    bool operator<(InputSource const& rhs) const
+    {
+        return id_ < rhs.id_;
+    }
+};
+
+} // tank
+
+#endif /* TANK_INPUTSOURCE_HPP */
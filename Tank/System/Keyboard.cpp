@@ -19,9 +19,13 @@ std::array<bool, Key::KeyCount> Keyboard::lastState_{};
 bool Keyboard::keyPressed_ {false};
 bool Keyboard::keyReleased_ {false};
 
-std::function<bool()> Keyboard::Control = control;
-std::function<bool()> Keyboard::Shift = shift;
-std::function<bool()> Keyboard::Alt = alt;
+const Keyboard::EitherKeyDown Keyboard::Control =
+        KeyDown(Key::LControl) || KeyDown(Key::RControl);
+const Keyboard::EitherKeyDown Keyboard::Shift =
+        KeyDown(Key::LShift) || KeyDown(Key::RShift);
+const Keyboard::EitherKeyDown Keyboard::Alt =
+        KeyDown(Key::LAlt) || KeyDown(Key::RAlt);
+
 void Keyboard::reset()
 {
     if (stateChange_) {
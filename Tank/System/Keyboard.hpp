@@ -8,6 +8,7 @@
 #include <SFML/Window/Keyboard.hpp>
 #include <functional>
 #include <array>
+#include "EventHandler.hpp"
 
 namespace tank
 {
@@ -25,7 +26,7 @@ using Key = sf::Keyboard::Key;
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
  * class MyEnt : public tank::Entity
  * {
- *     std::unique_ptr<tank::EventHandler::Connection> c;
+ *     tank::EventHandler::Connection c;
  * public:
  *     // Must manage connections in onAdded, as getWorld() is not set at
  *     // construction
@@ -49,6 +50,9 @@ using Key = sf::Keyboard::Key;
  * };
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  *
+ * The functions returning conditions tell the EventHandler which keys they
+ * read, so it only checks them when those keys change.
+ *
  * \see EventHandler
  */
 class Keyboard
@@ -62,79 +66,102 @@ class Keyboard
     static bool keyReleased_;
 
 public:
-    /*! \brief Function returning whether the specified Key is currently down */
-    static std::function<bool()> KeyDown(Key key)
+    /*! \brief returns whether the specified Key is currently down */
+    static bool isKeyDown(Key key)
     {
-        return [key]() { return isKeyDown(key); };
+        return currentState_[key];
     }
 
-    /*! \brief Function returning whether the specified Key is currently up */
-    static std::function<bool()> KeyUp(Key key)
+    /*! \brief returns whether the specified Key is currently up */
+    static bool isKeyUp(Key key)
     {
-        return [key]() { return not isKeyDown(key); };
+        return not isKeyDown(key);
     }
 
-    /*! \brief Function returning whether a Key has just been pressed */
-    static std::function<bool()> KeyPress()
+    /*! \brief returns whether a Key has just been pressed */
+    static bool isKeyPressed()
     {
-        return []() { return keyPressed_; };
+        return keyPressed_;
     }
 
-    /*! \brief Function returning whether the specified Key has just been pressed */
-    static std::function<bool()> KeyPress(Key key)
+    /*! \brief returns whether the specified Key has just been pressed */
+    static bool isKeyPressed(Key key)
     {
-        return [key]() { return isKeyPressed(key); };
+        return stateChange_ and currentState_[key] and not lastState_[key];
     }
 
-    /*! \brief Function returning whether a Key has just been released*/
-    static std::function<bool()> KeyRelease()
+    /*! \brief returns whether a Key has just been released */
+    static bool isKeyReleased()
     {
-        return []() { return keyReleased_; };
+        return keyReleased_;
     }
 
-    /*! \brief Function returning whether the specified Key has just been released*/
-    static std::function<bool()> KeyRelease(Key key)
+    /*! \brief returns whether the specified Key has just been released */
+    static bool isKeyReleased(Key key)
     {
-        return [key]() { return isKeyReleased(key); };
+        return stateChange_ and not currentState_[key] and lastState_[key];
     }
 
-    /*! \brief returns whether the specified Key is currently down */
-    static bool isKeyDown(Key key)
+    /*! \brief Condition type reading one key */
+    template <bool (*Test)(Key)>
+    using KeyCondition = InputCondition<detail::CallTestWith<Key, Test>>;
+
+    /*! \brief Condition type reading every key */
+    template <bool (*Test)()>
+    using AnyKeyCondition = InputCondition<detail::CallTest<Test>>;
+
+    /*! \brief Function returning whether the specified Key is currently down */
+    static KeyCondition<isKeyDown> KeyDown(Key key)
     {
-        return currentState_[key];
+        return {{key}, {{InputSource::key(key)}}};
     }
 
-    /*! \brief returns whether the specified Key is currently up */
-    static bool isKeyUp(Key key)
+    /*! \brief Function returning whether the specified Key is currently up */
+    static KeyCondition<isKeyUp> KeyUp(Key key)
     {
-        return not isKeyDown(key);
+        return {{key}, {{InputSource::key(key)}}};
     }
 
-    /*! \brief returns whether the specified Key has just been pressed */
-    static bool isKeyPressed(Key key)
+    /*! \brief Function returning whether a Key has just been pressed */
+    static AnyKeyCondition<isKeyPressed> KeyPress()
     {
-        return stateChange_ and currentState_[key] and not lastState_[key];
+        return {{}, {{InputSource::anyKey()}}};
     }
 
-    /*! \brief returns whether the specified Key has just been released */
-    static bool isKeyReleased(Key key)
+    /*! \brief Function returning whether the specified Key has just been pressed */
+    static KeyCondition<isKeyPressed> KeyPress(Key key)
     {
-        return stateChange_ and not currentState_[key] and lastState_[key];
+        return {{key}, {{InputSource::key(key)}}};
+    }
+
+    /*! \brief Function returning whether a Key has just been released*/
+    static AnyKeyCondition<isKeyReleased> KeyRelease()
+    {
+        return {{}, {{InputSource::anyKey()}}};
     }
 
-    static std::function<bool()> Control;
+    /*! \brief Function returning whether the specified Key has just been released*/
+    static KeyCondition<isKeyReleased> KeyRelease(Key key)
+    {
+        return {{key}, {{InputSource::key(key)}}};
+    }
+
+    using EitherKeyDown =
+            OrCondition<KeyCondition<isKeyDown>, KeyCondition<isKeyDown>>;
+
+    static const EitherKeyDown Control;
     static bool control()
     {
         return isKeyDown(Key::LControl) or isKeyDown(Key::RControl);
     }
 
-    static std::function<bool()> Shift;
+    static const EitherKeyDown Shift;
     static bool shift()
     {
         return isKeyDown(Key::LShift) or isKeyDown(Key::RShift);
     }
 
-    static std::function<bool()> Alt;
+    static const EitherKeyDown Alt;
     static bool alt()
     {
         return isKeyDown(Key::LAlt) or isKeyDown(Key::RAlt);;
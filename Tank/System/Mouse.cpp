@@ -60,14 +60,15 @@ bool Mouse::isButtonPressed(Button button)
     return currentState_[button] and not lastState_[button];
 }
 
-std::function<bool()> Mouse::ButtonPress()
+Mouse::MouseCondition<Mouse::isButtonPressed> Mouse::ButtonPress()
 {
-    return [] { return isButtonPressed(); };
+    return {{}, {{InputSource::anyMouseButton()}}};
 }
 
-std::function<bool()> Mouse::ButtonPress(Button button)
+Mouse::ButtonCondition<Mouse::isButtonPressed>
+        Mouse::ButtonPress(Button button)
 {
-    return [button] { return isButtonPressed(button); };
+    return {{button}, {{InputSource::mouseButton(button)}}};
 }
 
 bool Mouse::isButtonReleased()
@@ -83,14 +84,15 @@ bool Mouse::isButtonReleased(Button button)
     return lastState_[button] and not currentState_[button];
 }
 
-std::function<bool()> Mouse::ButtonRelease()
+Mouse::MouseCondition<Mouse::isButtonReleased> Mouse::ButtonRelease()
 {
-    return [] { return isButtonReleased(); };
+    return {{}, {{InputSource::anyMouseButton()}}};
 }
 
-std::function<bool()> Mouse::ButtonRelease(Button button)
+Mouse::ButtonCondition<Mouse::isButtonReleased>
+        Mouse::ButtonRelease(Button button)
 {
-    return [button] { return isButtonReleased(button); };
+    return {{button}, {{InputSource::mouseButton(button)}}};
 }
 
 bool Mouse::isButtonDown()
@@ -104,15 +106,15 @@ bool Mouse::isButtonDown(Button button)
     return currentState_[button];
 }
 
-std::function<bool()> Mouse::ButtonDown()
+Mouse::MouseCondition<Mouse::isButtonDown> Mouse::ButtonDown()
 {
-    return [] { return isButtonDown(); };
+    return {{}, {{InputSource::anyMouseButton()}}};
 }
 
 
-std::function<bool()> Mouse::ButtonDown(Button button)
+Mouse::ButtonCondition<Mouse::isButtonDown> Mouse::ButtonDown(Button button)
 {
-    return [button] { return isButtonDown(button); };
+    return {{button}, {{InputSource::mouseButton(button)}}};
 }
 
 bool Mouse::isButtonUp(Button button)
@@ -120,31 +122,49 @@ bool Mouse::isButtonUp(Button button)
     return not currentState_[button];
 }
 
-std::function<bool()> Mouse::ButtonUp(Button button)
+Mouse::ButtonCondition<Mouse::isButtonUp> Mouse::ButtonUp(Button button)
 {
-    return [button] { return isButtonUp(button); };
+    return {{button}, {{InputSource::mouseButton(button)}}};
 }
 
-std::function<bool()> Mouse::MouseMovement()
+bool Mouse::isMoving()
 {
-    return [] {
-        auto dt = delta();
-        return dt.x != 0 or dt.y != 0;
-    };
+    auto dt = delta();
+    return dt.x != 0 or dt.y != 0;
+}
+
+Mouse::MouseCondition<Mouse::isMoving> Mouse::MouseMovement()
+{
+    return {{}, {{InputSource::mouseMove()}}};
+}
+
+bool Mouse::isWheelUp()
+{
+    return wheelDelta() > 0;
 }
 
-std::function<bool()> Mouse::WheelUp()
+bool Mouse::isWheelDown()
 {
-    return [] { return wheelDelta() > 0; };
+    return wheelDelta() < 0;
 }
 
-std::function<bool()> Mouse::WheelDown()
+bool Mouse::isWheelMoved()
 {
-    return [] { return wheelDelta() < 0; };
+    return wheelDelta() != 0;
 }
-std::function<bool()> Mouse::WheelMovement()
+
+Mouse::MouseCondition<Mouse::isWheelUp> Mouse::WheelUp()
 {
-    return [] { return wheelDelta() != 0; };
+    return {{}, {{InputSource::mouseWheel()}}};
+}
+
+Mouse::MouseCondition<Mouse::isWheelDown> Mouse::WheelDown()
+{
+    return {{}, {{InputSource::mouseWheel()}}};
+}
+Mouse::MouseCondition<Mouse::isWheelMoved> Mouse::WheelMovement()
+{
+    return {{}, {{InputSource::mouseWheel()}}};
 }
 
 bool Mouse::isInEntity(Entity const& e)
@@ -209,7 +229,7 @@ void Mouse::reset()
 
     std::copy(currentState_.begin(), currentState_.end(), lastState_.begin());
 
-    if (locked_) {
+    if (locked_ and Game::window()) {
         sf::Mouse::setPosition({lockPos_.x, lockPos_.y},
                                Game::window()->SFMLWindow());
         currentPos_ = lockPos_;
@@ -225,7 +245,9 @@ void Mouse::reset()
 
 void Mouse::setVisibility(bool visible)
 {
-    Game::window()->SFMLWindow().setMouseCursorVisible(visible);
+    if (Game::window()) {
+        Game::window()->SFMLWindow().setMouseCursorVisible(visible);
+    }
     visible_ = visible;
 }
 }
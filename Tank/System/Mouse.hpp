@@ -12,6 +12,7 @@
 #include "../../Tank/Utility/Vector.hpp"
 #include "../../Tank/Utility/Rect.hpp"
 #include "../../Tank/System/Camera.hpp"
+#include "../../Tank/System/EventHandler.hpp"
 
 namespace tank
 {
@@ -47,25 +48,39 @@ public:
 
     static bool isButtonPressed();
     static bool isButtonPressed(Button button);
-    static std::function<bool()> ButtonPress();
-    static std::function<bool()> ButtonPress(Button button);
-
     static bool isButtonReleased();
     static bool isButtonReleased(Button button);
-    static std::function<bool()> ButtonRelease();
-    static std::function<bool()> ButtonRelease(Button button);
-
     static bool isButtonDown();
     static bool isButtonDown(Button button);
-    static std::function<bool()> ButtonDown();
-    static std::function<bool()> ButtonDown(Button button);
-
     static bool isButtonUp(Button button);
-    static std::function<bool()> ButtonUp(Button button);
+    static bool isWheelUp();
+    static bool isWheelDown();
+    static bool isWheelMoved();
+    static bool isMoving();
+
+    /*! \brief Condition type reading one button */
+    template <bool (*Test)(Button)>
+    using ButtonCondition =
+            InputCondition<detail::CallTestWith<Button, Test>>;
+
+    /*! \brief Condition type reading every button, the wheel or movement */
+    template <bool (*Test)()>
+    using MouseCondition = InputCondition<detail::CallTest<Test>>;
+
+    static MouseCondition<isButtonPressed> ButtonPress();
+    static ButtonCondition<isButtonPressed> ButtonPress(Button button);
+
+    static MouseCondition<isButtonReleased> ButtonRelease();
+    static ButtonCondition<isButtonReleased> ButtonRelease(Button button);
+
+    static MouseCondition<isButtonDown> ButtonDown();
+    static ButtonCondition<isButtonDown> ButtonDown(Button button);
+
+    static ButtonCondition<isButtonUp> ButtonUp(Button button);
 
-    static std::function<bool()> WheelUp();
-    static std::function<bool()> WheelDown();
-    static std::function<bool()> WheelMovement();
+    static MouseCondition<isWheelUp> WheelUp();
+    static MouseCondition<isWheelDown> WheelDown();
+    static MouseCondition<isWheelMoved> WheelMovement();
 
     static std::function<bool()> EnterWindow();
     static std::function<bool()> LeaveWindow();
@@ -87,7 +102,7 @@ public:
     static std::function<bool()> InEntity(Entity const&);
     static bool isInEntity(Entity const&);
 
-    static std::function<bool()> MouseMovement();
+    static MouseCondition<isMoving> MouseMovement();
 
     static bool isLocked()
     {
@@ -0,0 +1,389 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_SCRIPT_HPP
+#define TANK_SCRIPT_HPP
+
+// Scripts need C++20 coroutines. The rest of Tank doesn't, so without them
+// this header is empty.
+#if defined(__cpp_impl_coroutine) and __cpp_impl_coroutine >= 201902L
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "Entity.hpp"
+#include "ScriptScheduler.hpp"
+#include "World.hpp"
+#include "../Graphics/FrameList.hpp"
+#include "../Tweens/Tween.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief A behaviour written as a coroutine, which suspends while it waits
+ * rather than being polled every tick
+ *
+ * A script is a function returning Script that uses `co_await` to wait:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     tank::Script patrol(Guard& guard)
+ *     {
+ *         for (;;) {
+ *             co_await tank::animation(guard.frames, "walk_left");
+ *             co_await tank::wait(std::chrono::seconds(2));
+ *             co_await tank::until([&] { return guard.sawPlayer(); });
+ *             ...
+ *         }
+ *     }
+ *
+ *     void Guard::onAdded()
+ *     {
+ *         tank::runScript(*this, patrol(*this));
+ *     }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A script does nothing until passed to runScript(), which hands it to the
+ * world's ScriptScheduler. Exceptions thrown by a script come out of
+ * runScript() or World::update().
+ *
+ * Only available when compiling with C++20 coroutines.
+ */
+class Script
+{
+public:
+    struct promise_type
+    {
+        ScriptScheduler* scheduler {nullptr};
+        ScriptScheduler::Id id {0};
+
+        Script get_return_object()
+        {
+            return Script{Frame::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // The scheduler destroys finished scripts
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            throw;
+        }
+    };
+
+    using Frame = std::coroutine_handle<promise_type>;
+
+private:
+    Frame frame_;
+
+    explicit Script(Frame frame) : frame_(frame)
+    {
+    }
+
+public:
+    Script(Script&& other) noexcept : frame_(std::exchange(other.frame_, {}))
+    {
+    }
+
+    Script& operator=(Script&& other) noexcept
+    {
+        if (this != &other) {
+            if (frame_) {
+                frame_.destroy();
+            }
+            frame_ = std::exchange(other.frame_, {});
+        }
+        return *this;
+    }
+
+    Script(Script const&) = delete;
+    Script& operator=(Script const&) = delete;
+
+    ~Script()
+    {
+        if (frame_) {
+            frame_.destroy();
+        }
+    }
+
+    /*!
+     * \brief Gives up the coroutine frame, which the caller must destroy
+     */
+    Frame release()
+    {
+        return std::exchange(frame_, {});
+    }
+};
+
+namespace detail
+{
+inline ScriptScheduler::FrameOps const& scriptOps()
+{
+    static const ScriptScheduler::FrameOps ops = {
+            [](void* frame, ScriptScheduler& scheduler,
+               ScriptScheduler::Id id) {
+                auto& promise = Script::Frame::from_address(frame).promise();
+                promise.scheduler = &scheduler;
+                promise.id = id;
+            },
+            [](void* frame) { Script::Frame::from_address(frame).resume(); },
+            [](void* frame) {
+                return Script::Frame::from_address(frame).done();
+            },
+            [](void* frame) { Script::Frame::from_address(frame).destroy(); }};
+    return ops;
+}
+
+inline ScriptScheduler::Id startScript(ScriptScheduler& scheduler,
+                                       Script script, Entity* owner)
+{
+    Script::Frame frame = script.release();
+    if (not frame) {
+        throw std::invalid_argument("Script has already been started");
+    }
+    return scheduler.start(frame.address(), scriptOps(), owner);
+}
+
+// Resumes the awaiting script when a callback fires. The id keeps a script
+// that has since been destroyed from being resumed, and the weak pointer
+// does the same once its world has gone.
+inline std::function<void()> resumer(Script::Frame frame)
+{
+    std::weak_ptr<ScriptScheduler*> weak = frame.promise().scheduler->getWeak();
+    const ScriptScheduler::Id id = frame.promise().id;
+    return [weak, id] {
+        if (auto scheduler = weak.lock()) {
+            (*scheduler)->resumeNextTick(id);
+        }
+    };
+}
+} // detail
+
+/*!
+ * \brief Runs a script in a world, until it finishes
+ *
+ * The script runs straight away, up to its first `co_await`.
+ *
+ * \return The script's id in World::scripts
+ */
+inline ScriptScheduler::Id runScript(World& world, Script script)
+{
+    return detail::startScript(world.scripts, std::move(script), nullptr);
+}
+
+/*!
+ * \brief Runs a script belonging to an entity, until it finishes or the
+ * entity is destroyed
+ *
+ * \throws std::logic_error if the entity isn't in a world
+ */
+inline ScriptScheduler::Id runScript(Entity& entity, Script script)
+{
+    observing_ptr<World> world = entity.getWorld();
+    if (not world) {
+        throw std::logic_error("Entity must be in a world to run scripts");
+    }
+    return detail::startScript(world->scripts, std::move(script), &entity);
+}
+
+/*!
+ * \brief Awaitable that suspends a script for a number of ticks
+ *
+ * \see waitTicks()
+ */
+struct TickWait
+{
+    std::uint64_t ticks;
+
+    bool await_ready() const noexcept
+    {
+        return ticks == 0;
+    }
+
+    void await_suspend(Script::Frame frame) const
+    {
+        auto& promise = frame.promise();
+        promise.scheduler->resumeAt(promise.id,
+                                    promise.scheduler->getTick() + ticks);
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/*!
+ * \brief Suspends a script until the next time the world's scripts run
+ */
+inline TickWait nextTick()
+{
+    return {1};
+}
+
+/*!
+ * \brief Suspends a script until its world's scripts have run n more times
+ */
+inline TickWait waitTicks(std::uint64_t n)
+{
+    return {n};
+}
+
+/*!
+ * \brief Suspends a script for a length of time, rounded up to whole ticks
+ * at Game::fps ticks a second
+ */
+template <typename Rep, typename Period>
+TickWait wait(std::chrono::duration<Rep, Period> duration)
+{
+    return {World::toTicks(duration)};
+}
+
+/*!
+ * \brief Awaitable that suspends a script until a condition holds
+ *
+ * \see until()
+ */
+struct ConditionWait
+{
+    std::function<bool()> ready;
+
+    bool await_ready() const
+    {
+        return ready();
+    }
+
+    void await_suspend(Script::Frame frame)
+    {
+        auto& promise = frame.promise();
+        promise.scheduler->resumeWhen(promise.id, std::move(ready));
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/*!
+ * \brief Suspends a script until condition() returns true
+ *
+ * The condition is checked once per tick, so this is the one wait that
+ * costs something while suspended. If it is already true, the script
+ * carries on without suspending.
+ */
+inline ConditionWait until(std::function<bool()> condition)
+{
+    return {std::move(condition)};
+}
+
+/*!
+ * \brief Awaitable that suspends a script until a tween function ends
+ *
+ * \see finished()
+ */
+template <typename T>
+struct TweenWait
+{
+    Tween<T>& tween;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(Script::Frame frame)
+    {
+        Tween<T>* tween = &this->tween;
+        auto resume = detail::resumer(frame);
+        tween->setCallback([tween, resume] {
+            auto resumeScript = resume;
+            tween->setCallback();
+            resumeScript();
+        });
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/*!
+ * \brief Suspends a script until the tween's current function ends
+ *
+ * This replaces the tween's callback, and clears it once it has fired. A
+ * tween only notices it has ended when its value is read, so something must
+ * keep calling Tween.getValue().
+ */
+template <typename T>
+TweenWait<T> finished(Tween<T>& tween)
+{
+    return {tween};
+}
+
+/*!
+ * \brief Awaitable that plays an animation and suspends a script until it
+ * ends
+ *
+ * The frame list must be drawn, or culled by World.draw(), each frame;
+ * otherwise the animation never ends and the script waits for ever.
+ *
+ * \see animation()
+ */
+struct AnimationWait
+{
+    FrameList& frames;
+    std::string name;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(Script::Frame frame)
+    {
+        frames.select(name, false, detail::resumer(frame));
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+/*!
+ * \brief Plays an animation once, suspending a script until it ends
+ *
+ * The animation advances as the frame list is drawn, or culled by
+ * World.draw(), so it must belong to a visible graphic of a listed entity
+ * for the script to carry on.
+ *
+ * \param frames The frame list to play it on
+ * \param name The animation, as passed to FrameList.add()
+ */
+inline AnimationWait animation(FrameList& frames, std::string name)
+{
+    return {frames, std::move(name)};
+}
+
+} // tank
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /* TANK_SCRIPT_HPP */
@@ -0,0 +1,208 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ScriptScheduler.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include "Entity.hpp"
+
+namespace tank
+{
+
+ScriptScheduler::ScriptScheduler()
+        : self_(std::make_shared<ScriptScheduler*>(this))
+{
+}
+
+ScriptScheduler::~ScriptScheduler()
+{
+    clear();
+}
+
+ScriptScheduler::Id ScriptScheduler::start(void* frame, FrameOps const& ops,
+                                           Entity* owner)
+{
+    std::uint32_t index;
+    if (freeSlots_.empty()) {
+        index = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back({nullptr, nullptr, {}, false, 0});
+    } else {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+
+    Slot& slot = slots_[index];
+    slot.frame = frame;
+    slot.ops = &ops;
+    slot.owned = owner != nullptr;
+    slot.owner = owner ? owner->getHandle() : EntityHandle{};
+    if (owner) {
+        ++owner->scriptCount_;
+    }
+    ++running_;
+
+    const Id id = static_cast<Id>(slot.generation) << 32 | index;
+    ops.attach(frame, *this, id);
+    resume(id);
+    return id;
+}
+
+void ScriptScheduler::resumeNextTick(Id id)
+{
+    ready_.push_back(id);
+}
+
+void ScriptScheduler::resumeAt(Id id, std::uint64_t tick)
+{
+    timers_.push_back({tick, id});
+    std::push_heap(timers_.begin(), timers_.end(), later);
+}
+
+void ScriptScheduler::resumeWhen(Id id, std::function<bool()> ready)
+{
+    conditions_.push_back({std::move(ready), id});
+}
+
+void ScriptScheduler::cancel(EntityHandle owner)
+{
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        Slot const& slot = slots_[i];
+        if (slot.frame and slot.owned and slot.owner == owner) {
+            destroy(static_cast<Id>(slot.generation) << 32 | i);
+        }
+    }
+}
+
+void ScriptScheduler::clear()
+{
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].frame) {
+            destroy(static_cast<Id>(slots_[i].generation) << 32 | i);
+        }
+    }
+    ready_.clear();
+    timers_.clear();
+    conditions_.clear();
+}
+
+void ScriptScheduler::run(std::uint64_t tick)
+{
+    tick_ = tick;
+
+    while (not timers_.empty() and timers_.front().tick <= tick) {
+        std::pop_heap(timers_.begin(), timers_.end(), later);
+        ready_.push_back(timers_.back().id);
+        timers_.pop_back();
+    }
+
+    // A condition may start scripts that wait on conditions of their own.
+    // Those go into conditions_ while this run checks a list of its own, so
+    // the function being called is never moved.
+    checking_.swap(conditions_);
+    for (std::size_t i = 0; i < checking_.size(); ++i) {
+        Condition& condition = checking_[i];
+        bool ready;
+        try {
+            ready = find(condition.id) and condition.ready();
+        } catch (...) {
+            std::move(checking_.begin() + i, checking_.end(),
+                      std::back_inserter(conditions_));
+            checking_.clear();
+            throw;
+        }
+
+        if (ready) {
+            ready_.push_back(condition.id);
+        } else if (find(condition.id)) {
+            conditions_.push_back(std::move(condition));
+        }
+    }
+    checking_.clear();
+
+    // Scripts asking for the next tick from here on wait for the next run
+    resuming_.swap(ready_);
+    for (std::size_t i = 0; i < resuming_.size(); ++i) {
+        try {
+            resume(resuming_[i]);
+        } catch (...) {
+            ready_.insert(ready_.begin(), resuming_.begin() + i + 1,
+                          resuming_.end());
+            resuming_.clear();
+            throw;
+        }
+    }
+    resuming_.clear();
+}
+
+ScriptScheduler::Slot* ScriptScheduler::find(Id id)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(id);
+    if (index < slots_.size() and slots_[index].frame and
+        slots_[index].generation == static_cast<std::uint32_t>(id >> 32)) {
+        return &slots_[index];
+    }
+    return nullptr;
+}
+
+void ScriptScheduler::resume(Id id)
+{
+    Slot* slot = find(id);
+    if (not slot) {
+        return;
+    }
+
+    // A script outliving its entity is stopped where it is
+    if (slot->owned and not slot->owner) {
+        destroy(id);
+        return;
+    }
+
+    // Resuming may start other scripts, moving slots_
+    void* frame = slot->frame;
+    FrameOps const* ops = slot->ops;
+    try {
+        ops->resume(frame);
+    } catch (...) {
+        destroy(id);
+        throw;
+    }
+
+    if (find(id) and ops->done(frame)) {
+        destroy(id);
+    }
+}
+
+bool ScriptScheduler::later(Timer const& a, Timer const& b)
+{
+    return a.tick > b.tick;
+}
+
+void ScriptScheduler::destroy(Id id)
+{
+    Slot* slot = find(id);
+    if (not slot) {
+        return;
+    }
+
+    // Clear the slot first: destroying the frame runs the script's
+    // destructors, which may start or cancel scripts
+    void* frame = slot->frame;
+    FrameOps const* ops = slot->ops;
+    if (Entity* owner = slot->owner.get()) {
+        if (slot->owned) {
+            --owner->scriptCount_;
+        }
+    }
+    slot->frame = nullptr;
+    slot->owner = {};
+    ++slot->generation;
+    freeSlots_.push_back(static_cast<std::uint32_t>(id));
+    --running_;
+
+    ops->destroy(frame);
+}
+
+} // tank
@@ -0,0 +1,184 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_SCRIPTSCHEDULER_HPP
+#define TANK_SCRIPTSCHEDULER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "EntityHandle.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief Runs a World's scripts, resuming each only when it is ready to
+ * continue
+ *
+ * Scripts are written as coroutines returning Script (see Script.hpp), and
+ * started with runScript(). Each world has a scheduler, World::scripts, which
+ * World::update() runs once per tick after Entity.update().
+ *
+ * A suspended script costs nothing until what it waits for happens: scripts
+ * waiting for the next tick are kept in a list, scripts waiting for time to
+ * pass in a heap ordered on the tick they wake, and scripts waiting for a
+ * callback (from a Tween or FrameList) aren't kept anywhere until the callback
+ * comes. Only scripts waiting with until() are checked every tick.
+ *
+ * The scheduler itself doesn't depend on coroutines, so that World is the same
+ * whichever standard a game is compiled with; it deals in opaque frames
+ * resumed through a table of functions.
+ */
+class ScriptScheduler
+{
+public:
+    /*! \brief Identifies a running script. Stale ids are ignored. */
+    using Id = std::uint64_t;
+
+    /*!
+     * \brief How to resume, check and destroy a script's frame
+     *
+     * attach() tells the frame which scheduler it is in and its id, before
+     * it is first resumed.
+     */
+    struct FrameOps
+    {
+        void (*attach)(void* frame, ScriptScheduler& scheduler, Id id);
+        void (*resume)(void* frame);
+        bool (*done)(void* frame);
+        void (*destroy)(void* frame);
+    };
+
+private:
+    struct Slot
+    {
+        void* frame;
+        FrameOps const* ops;
+        EntityHandle owner;
+        bool owned;
+        std::uint32_t generation;
+    };
+
+    struct Timer
+    {
+        std::uint64_t tick;
+        Id id;
+    };
+
+    struct Condition
+    {
+        std::function<bool()> ready;
+        Id id;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> freeSlots_;
+    std::size_t running_ {0};
+    std::uint64_t tick_ {0};
+
+    std::vector<Id> ready_;
+    std::vector<Id> resuming_;
+    std::vector<Timer> timers_; // Min-heap on tick
+    std::vector<Condition> conditions_;
+    std::vector<Condition> checking_;
+
+    // Points back here. Only the scheduler owns it, so weak pointers to it
+    // expire with the scheduler.
+    std::shared_ptr<ScriptScheduler*> self_;
+
+public:
+    ScriptScheduler();
+    ScriptScheduler(ScriptScheduler const&) = delete;
+    ScriptScheduler& operator=(ScriptScheduler const&) = delete;
+    ~ScriptScheduler();
+
+    /*!
+     * \brief Takes ownership of a script's frame and runs it until it first
+     * suspends
+     *
+     * \param frame The script's coroutine frame
+     * \param ops How to resume and destroy it
+     * \param owner The entity the script belongs to, or nullptr. A script is
+     *        destroyed, rather than resumed, once its entity has been.
+     * \return The script's id
+     */
+    Id start(void* frame, FrameOps const& ops, Entity* owner);
+
+    /*! \brief Resumes a script in the next run() */
+    void resumeNextTick(Id id);
+
+    /*!
+     * \brief Resumes a script in the first run() on or after tick
+     *
+     * getTick() + n is the nth run() from now.
+     */
+    void resumeAt(Id id, std::uint64_t tick);
+
+    /*! \brief Resumes a script in the first run() in which ready() is true */
+    void resumeWhen(Id id, std::function<bool()> ready);
+
+    /*!
+     * \brief Destroys the scripts belonging to an entity
+     *
+     * World calls this when it deletes an entity, so scripts waiting for
+     * something that will never come don't linger.
+     */
+    void cancel(EntityHandle owner);
+
+    /*!
+     * \brief Destroys every script
+     */
+    void clear();
+
+    /*!
+     * \brief Resumes every script whose wait is over
+     *
+     * Scripts that ask for the next tick while being resumed are resumed in
+     * the next run(), not this one, and conditions added while conditions
+     * are being checked are first checked in the next run().
+     *
+     * If a script throws, it is destroyed and the exception passed on; the
+     * rest of the run is left for next time.
+     *
+     * \param tick The world's tick count
+     */
+    void run(std::uint64_t tick);
+
+    /*!
+     * \brief Returns a pointer to the scheduler that expires with it
+     *
+     * Callbacks that may fire after the world has gone, like those resuming
+     * scripts from a Tween or FrameList, hold this rather than the
+     * scheduler itself.
+     */
+    std::weak_ptr<ScriptScheduler*> getWeak() const
+    {
+        return self_;
+    }
+
+    /*! \brief Returns the tick passed to the last run() */
+    std::uint64_t getTick() const
+    {
+        return tick_;
+    }
+
+    /*! \brief Returns the number of scripts running or waiting */
+    std::size_t size() const
+    {
+        return running_;
+    }
+
+private:
+    static bool later(Timer const& a, Timer const& b);
+    Slot* find(Id id);
+    void resume(Id id);
+    void destroy(Id id);
+};
+
+} // tank
+
+#endif /* TANK_SCRIPTSCHEDULER_HPP */
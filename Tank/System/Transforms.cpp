@@ -0,0 +1,45 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "Transforms.hpp"
+
+namespace tank
+{
+
+constexpr std::uint32_t Transforms::blockSize;
+
+Transforms& Transforms::unlisted()
+{
+    // Never destroyed, like the handle table, so static entities can outlive
+    // everything else
+    static Transforms* store = new Transforms;
+    return *store;
+}
+
+void Transforms::copy(Transforms& from, std::uint32_t fromSlot,
+                      Transforms& to, std::uint32_t toSlot)
+{
+    Block const& src = from.block(fromSlot);
+    Block& dst = to.block(toSlot);
+    const std::uint32_t i = fromSlot % blockSize;
+    const std::uint32_t j = toSlot % blockSize;
+    dst.pos[j] = src.pos[i];
+    dst.lastPos[j] = src.lastPos[i];
+    dst.rot[j] = src.rot[i];
+    dst.lastRot[j] = src.lastRot[i];
+    dst.origin[j] = src.origin[i];
+    dst.hitbox[j] = src.hitbox[i];
+}
+
+void Transforms::reserve(std::uint32_t slot)
+{
+    // Slots are handed out from the bottom up, so this grows a block at a
+    // time
+    while (blocks_.size() <= slot / blockSize) {
+        blocks_.emplace_back(new Block);
+    }
+}
+
+} // tank
@@ -0,0 +1,154 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_TRANSFORMS_HPP
+#define TANK_TRANSFORMS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../Utility/Rect.hpp"
+#include "../Utility/Vector.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief Entities' positions, rotations, origins and hitboxes, stored a field
+ * at a time.
+ *
+ * Each World has a Transforms of its own, and an entity's transform lives at
+ * its slot there: its place in the world's entity list. Slots are grouped in
+ * blocks of blockSize, and within a block each field is an array of its own,
+ * so a pass over a world's positions reads packed memory, in update order,
+ * instead of visiting each Entity:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     auto& transforms = world.getTransforms();
+ *     auto const& slots = world.getSlots();
+ *     for (std::size_t i = 0; i < slots.size(); ++i) {
+ *         if (slots[i] != tank::EntityHandle::nullIndex) {
+ *             transforms.pos(slots[i]) += wind;
+ *             world.markMoved(i);
+ *         }
+ *     }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Writing here directly skips Entity.setPos(), so the world doesn't know the
+ * entity has moved until World.markMoved() is called for it.
+ *
+ * Entities that aren't listed in a world keep their transform in unlisted(),
+ * at the index of their EntityHandle. An entity's transform moves when it
+ * joins or leaves a world, and when entities before it are removed, so
+ * references to a field are only good until the next update(); look slots
+ * up again each tick.
+ *
+ * Like the handle table, this isn't locked: entities should only be created,
+ * moved and destroyed on the main thread.
+ *
+ * \see Entity.getSlot()
+ * \see World.getSlots()
+ */
+class Transforms
+{
+public:
+    /*! \brief How many slots each block holds */
+    static constexpr std::uint32_t blockSize = 1024;
+
+    /*! \brief The fields of blockSize consecutive slots */
+    struct Block
+    {
+        Vectorf pos[blockSize];
+        Vectorf lastPos[blockSize];
+        float rot[blockSize];
+        float lastRot[blockSize];
+        Vectorf origin[blockSize];
+        Rectd hitbox[blockSize];
+    };
+
+private:
+    // Blocks are never moved or freed while the store lives, so entities
+    // can keep a pointer to theirs
+    std::vector<std::unique_ptr<Block>> blocks_;
+
+public:
+    Transforms() = default;
+    Transforms(Transforms const&) = delete;
+    Transforms& operator=(Transforms const&) = delete;
+
+    /*!
+     * \brief Returns the store of entities that aren't listed in a world
+     *
+     * It is never destroyed, so entities owned by static objects never
+     * outlive their transforms.
+     */
+    static Transforms& unlisted();
+
+    /*!
+     * \brief Copies the transform at one slot to a slot in another store
+     *
+     * The destination slot must have been reserved.
+     */
+    static void copy(Transforms& from, std::uint32_t fromSlot,
+                     Transforms& to, std::uint32_t toSlot);
+
+    /*!
+     * \brief Makes sure the block holding slot exists
+     */
+    void reserve(std::uint32_t slot);
+
+    /*!
+     * \brief Returns the block holding slot, which must have been reserved
+     */
+    Block& block(std::uint32_t slot)
+    {
+        return *blocks_[slot / blockSize];
+    }
+
+    Vectorf& pos(std::uint32_t slot)
+    {
+        return block(slot).pos[slot % blockSize];
+    }
+
+    Vectorf& lastPos(std::uint32_t slot)
+    {
+        return block(slot).lastPos[slot % blockSize];
+    }
+
+    float& rot(std::uint32_t slot)
+    {
+        return block(slot).rot[slot % blockSize];
+    }
+
+    float& lastRot(std::uint32_t slot)
+    {
+        return block(slot).lastRot[slot % blockSize];
+    }
+
+    Vectorf& origin(std::uint32_t slot)
+    {
+        return block(slot).origin[slot % blockSize];
+    }
+
+    Rectd& hitbox(std::uint32_t slot)
+    {
+        return block(slot).hitbox[slot % blockSize];
+    }
+
+    /*!
+     * \brief Returns the hitbox of the entity at slot, offset by its position
+     */
+    Rectd worldHitbox(std::uint32_t slot)
+    {
+        Block const& b = block(slot);
+        const std::uint32_t i = slot % blockSize;
+        return {b.hitbox[i].x + b.pos[i].x, b.hitbox[i].y + b.pos[i].y,
+                b.hitbox[i].w, b.hitbox[i].h};
+    }
+};
+
+} // tank
+
+#endif /* TANK_TRANSFORMS_HPP */
@@ -0,0 +1,82 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "TypeTag.hpp"
+
+namespace tank
+{
+
+constexpr std::size_t TypeTag::maskedTypes;
+constexpr TypeTag::Mask TypeTag::overflowBit;
+constexpr TypeTag::Mask TypeTag::allTypes;
+std::unordered_map<std::string, std::size_t> TypeTag::ids_;
+std::deque<std::vector<std::string>> TypeTag::names_;
+
+std::size_t TypeTag::intern(std::string const& name)
+{
+    std::size_t id;
+    if (find(name, id)) {
+        return id;
+    }
+
+    id = names_.size();
+    names_.emplace_back(1, name);
+    ids_.emplace(name, id);
+    return id;
+}
+
+bool TypeTag::find(std::string const& name, std::size_t& id)
+{
+    auto iter = ids_.find(name);
+    if (iter == ids_.end()) {
+        return false;
+    }
+    id = iter->second;
+    return true;
+}
+
+TypeTag::Mask TypeTag::mask(std::string const& name)
+{
+    return bit(intern(name));
+}
+
+TypeTag::Mask TypeTag::mask(std::vector<std::string> const& names)
+{
+    Mask result = 0;
+    for (auto const& name : names) {
+        result |= mask(name);
+    }
+    return result;
+}
+
+TypeTag::Query TypeTag::query(std::string const& name)
+{
+    Query result {0, {}};
+    std::size_t id;
+    if (find(name, id)) {
+        result.mask = bit(id);
+        if (id >= maskedTypes) {
+            result.overflow.push_back(id);
+        }
+    }
+    return result;
+}
+
+TypeTag::Query TypeTag::query(std::vector<std::string> const& names)
+{
+    Query result {0, {}};
+    for (auto const& name : names) {
+        std::size_t id;
+        if (find(name, id)) {
+            result.mask |= bit(id);
+            if (id >= maskedTypes) {
+                result.overflow.push_back(id);
+            }
+        }
+    }
+    return result;
+}
+
+} // tank
@@ -0,0 +1,183 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_TYPETAG_HPP
+#define TANK_TYPETAG_HPP
+
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tank
+{
+
+/*!
+ * \brief The global registry of entity type names.
+ *
+ * Each name given to Entity.setType() or Entity.addType() is interned here
+ * the first time it is seen, and given a small integer id for good. An
+ * entity's types are then a Mask with the bit for each id set, so checking
+ * an entity against a list of types is a single AND:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     static const auto solid = tank::TypeTag::mask({"wall", "crate"});
+ *     auto hits = player->collide(solid);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * mask() adds the names it is given, so the mask above still matches walls
+ * made after it was built. Names are only added from the main thread, so the
+ * registry isn't locked, and masks must be built there too. query() never
+ * adds a name, so may be called from any thread.
+ *
+ * The first maskedTypes names each get a bit of their own. Any names after
+ * that share overflowBit, so a mask can't tell them apart, and the calls
+ * taking a Mask treat them as one type. The calls taking names, such as
+ * `collide("wall")`, use a Query, which can, so they stay exact however many
+ * names there are.
+ *
+ * \see Entity.collide()
+ * \see World.getEntitiesOfType()
+ */
+class TypeTag
+{
+    static std::unordered_map<std::string, std::size_t> ids_;
+    // Each name in a list of its own; see single(). A deque, so the lists
+    // never move.
+    static std::deque<std::vector<std::string>> names_;
+
+public:
+    /*! \brief A set of types, one bit per id */
+    using Mask = std::uint64_t;
+
+    /*! \brief How many type names get a bit of their own */
+    static constexpr std::size_t maskedTypes = 63;
+
+    /*! \brief The bit shared by every type name after the first maskedTypes */
+    static constexpr Mask overflowBit = Mask{1} << maskedTypes;
+
+    /*! \brief A mask matching any entity with at least one type */
+    static constexpr Mask allTypes = ~Mask{0};
+
+    /*!
+     * \brief Type names to match against, as a mask, along with the ids of
+     * any of them that share overflowBit
+     */
+    struct Query
+    {
+        Mask mask;
+        std::vector<std::size_t> overflow;
+
+        /*!
+         * \brief Returns whether something with the given type mask and ids
+         * has any of the queried types
+         */
+        template <typename Ids>
+        bool matches(Mask types, Ids const& ids) const
+        {
+            const Mask common = types & mask;
+            if (common & ~overflowBit) {
+                return true;
+            }
+            if (not common) {
+                return false;
+            }
+
+            // A query made from a Mask can't tell the shared types apart
+            if (overflow.empty()) {
+                return true;
+            }
+            for (std::size_t id : ids) {
+                for (std::size_t wanted : overflow) {
+                    if (id == wanted) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+
+    /*!
+     * \brief Returns the id of a type name, adding it if it is new
+     */
+    static std::size_t intern(std::string const& name);
+
+    /*!
+     * \brief Looks up the id of a type name, without adding it
+     *
+     * \param name The type name
+     * \param id Set to the name's id, if it has one
+     * \return `false` if the name hasn't been added
+     */
+    static bool find(std::string const& name, std::size_t& id);
+
+    /*!
+     * \brief Returns the name with a given id
+     */
+    static std::string const& name(std::size_t id)
+    {
+        return names_.at(id).front();
+    }
+
+    /*!
+     * \brief Returns a list holding only the name with a given id
+     *
+     * Entities with a single type share this, rather than each keeping a
+     * list of their own. It lasts for the life of the program.
+     */
+    static std::vector<std::string> const& single(std::size_t id)
+    {
+        return names_.at(id);
+    }
+
+    /*!
+     * \brief Returns the mask with only the bit for id set, which is
+     * overflowBit for ids past maskedTypes
+     */
+    static Mask bit(std::size_t id)
+    {
+        return id < maskedTypes ? Mask{1} << id : overflowBit;
+    }
+
+    /*!
+     * \brief Returns the mask for a type name, adding the name if it is new
+     *
+     * Only call this from the main thread.
+     */
+    static Mask mask(std::string const& name);
+
+    /*!
+     * \brief Returns the mask matching any of a list of type names, adding
+     * any that are new
+     *
+     * Only call this from the main thread.
+     */
+    static Mask mask(std::vector<std::string> const& names);
+
+    static Mask mask(std::initializer_list<std::string> names)
+    {
+        return mask(std::vector<std::string>(names));
+    }
+
+    /*!
+     * \brief Looks up a type name to match against, without adding it
+     *
+     * A name no entity has ever had matches nothing.
+     */
+    static Query query(std::string const& name);
+
+    /*!
+     * \brief Looks up a list of type names to match against any of, without
+     * adding them
+     */
+    static Query query(std::vector<std::string> const& names);
+};
+
+} // tank
+
+#endif /* TANK_TYPETAG_HPP */
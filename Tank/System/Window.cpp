@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include "Game.hpp"
+#include "../Utility/Profiler.hpp"
 
 namespace tank
 {
@@ -42,6 +43,8 @@ Window::Window(Vector<unsigned int> size, std::string caption)
 
 Window::~Window()
 {
+    setThreadedRendering(false);
+
     if (windowExists_ && valid_) {
         Game::log << "Closing Window" << std::endl;
         windowExists_ = false;
@@ -50,19 +53,175 @@ Window::~Window()
 
 bool Window::pollEvent(sf::Event& event)
 {
+    if (not events_.empty()) {
+        event = events_.front();
+        events_.pop_front();
+        return true;
+    }
+    if (isThreadedRendering()) {
+        return false;
+    }
     return window_.pollEvent(event);
 }
 
 void Window::flipDisplay()
 {
-    window_.display();
-    window_.clear(backgroundColor_);
+    TANK_PROFILE_ZONE("Window::flipDisplay");
+
+    if (not isThreadedRendering()) {
+        window_.display();
+        window_.clear(backgroundColor_);
+        return;
+    }
+
+    {
+        // Wait for the render thread to finish the last frame
+        std::unique_lock<std::mutex> lock(renderMutex_);
+        frameRendered_.wait(lock, [this] { return not frameReady_; });
+
+        // The render thread is idle, so SFML may change the view
+        applyResize();
+        sf::Event event;
+        while (window_.pollEvent(event)) {
+            events_.push_back(event);
+        }
+
+        // The render thread clears to the color the frame was finished with
+        recording_->setClearColor(backgroundColor_);
+        std::swap(recording_, submitted_);
+        frameReady_ = true;
+    }
+    frameSubmitted_.notify_one();
+
+    recording_->clear();
+}
+
+template <typename T>
+void Window::drawOrRecord(T const& drawable)
+{
+    if (isThreadedRendering()) {
+        recording_->add(drawable);
+    } else {
+        window_.draw(drawable);
+    }
+}
+
+void Window::draw(sf::Sprite const& sprite,
+                  std::shared_ptr<Texture const> texture)
+{
+    if (isThreadedRendering()) {
+        recording_->add(sprite, std::move(texture));
+    } else {
+        window_.draw(sprite);
+    }
+}
+
+void Window::draw(sf::CircleShape const& circle)
+{
+    drawOrRecord(circle);
+}
+
+void Window::draw(sf::RectangleShape const& rectangle)
+{
+    drawOrRecord(rectangle);
+}
+
+void Window::draw(sf::ConvexShape const& convex)
+{
+    drawOrRecord(convex);
+}
+
+void Window::draw(sf::Text const& text, std::shared_ptr<Font const> font)
+{
+    if (isThreadedRendering()) {
+        recording_->add(text, std::move(font));
+    } else {
+        window_.draw(text);
+    }
+}
+
+void Window::setThreadedRendering(bool threaded)
+{
+    if (threaded == isThreadedRendering() or not valid_) {
+        return;
+    }
+
+    if (threaded) {
+        Game::log << "Starting render thread" << std::endl;
+
+        // The OpenGL context can only be active on one thread at a time
+        window_.setActive(false);
+        stopRendering_ = false;
+        frameReady_ = false;
+        recording_->clear();
+        renderThread_ = std::thread(&Window::render, this);
+    } else {
+        Game::log << "Stopping render thread" << std::endl;
+
+        {
+            std::lock_guard<std::mutex> lock(renderMutex_);
+            stopRendering_ = true;
+        }
+        frameSubmitted_.notify_one();
+        renderThread_.join();
+
+        window_.setActive(true);
+        recording_->clear();
+        submitted_->clear();
+        applyResize();
+    }
+}
+
+void Window::render()
+{
+    window_.setActive(true);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(renderMutex_);
+            frameSubmitted_.wait(lock, [this] {
+                return frameReady_ or stopRendering_;
+            });
+            if (not frameReady_) {
+                break;
+            }
+        }
+
+        {
+            TANK_PROFILE_ZONE("Window::render");
+            // The main thread leaves submitted_ alone until frameReady_ is
+            // unset
+            submitted_->replay(window_);
+            window_.display();
+            window_.clear(submitted_->getClearColor());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(renderMutex_);
+            frameReady_ = false;
+        }
+        frameRendered_.notify_one();
+    }
+
+    window_.setActive(false);
 }
 
 void Window::setSize(Vectoru size)
 {
-    window_.setSize({size.x, size.y});
     size_ = size;
+    pendingSize_ = size;
+    resizePending_ = true;
+    if (not isThreadedRendering()) {
+        applyResize();
+    }
+}
+
+void Window::applyResize()
+{
+    if (resizePending_) {
+        window_.setSize({pendingSize_.x, pendingSize_.y});
+        resizePending_ = false;
+    }
 }
 
 void Window::setBackgroundColor(float r, float g, float b, float a)
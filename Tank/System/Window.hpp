@@ -6,9 +6,16 @@
 #ifndef TANK_WINDOW_HPP
 #define TANK_WINDOW_HPP
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include "../Graphics/Color.hpp"
+#include "../Graphics/Texture.hpp"
 #include "../Utility/Vector.hpp"
+#include "DrawList.hpp"
 
 namespace sf {
 class Event;
@@ -16,6 +23,29 @@ class Event;
 
 namespace tank {
 
+/*!
+ * \brief The game window
+ *
+ * Graphics are drawn with the Window::draw() functions. Normally these draw
+ * straight to the window, and flipDisplay() shows the result.
+ *
+ * With setThreadedRendering(), a separate render thread does all the drawing
+ * instead. Draw calls are recorded into a DrawList, and flipDisplay() hands the
+ * list to the render thread and starts recording the next frame into a second
+ * list. The render thread replays the first list while the game updates the
+ * next frame, so a frame takes about as long as the slower of the two rather
+ * than both added together. The cost is that what's on screen is a frame
+ * behind the game.
+ *
+ * The render thread and the window share SFML state, so while it runs,
+ * setSize() and the events pollEvent() returns only take effect in
+ * flipDisplay(), once the last frame has been drawn.
+ *
+ * While the render thread is running, don't use SFMLWindow() to draw, and
+ * bear in mind that changes to a texture may show up in the frame being
+ * replayed. Fonts passed to Text by reference rather than by shared pointer
+ * must outlive the frame after the one they were last drawn in.
+ */
 class Window
 {
     sf::RenderWindow window_;
@@ -30,6 +60,23 @@ class Window
     // Unfortunately we can only have one window right now
     static bool windowExists_;
 
+    // Threaded rendering
+    DrawList drawLists_[2];
+    DrawList* recording_{&drawLists_[0]};
+    DrawList* submitted_{&drawLists_[1]};
+    std::thread renderThread_;
+    std::mutex renderMutex_;
+    std::condition_variable frameSubmitted_;
+    std::condition_variable frameRendered_;
+    bool frameReady_{false};
+    bool stopRendering_{false};
+    // SFML resets the view when the window is resized, which the render
+    // thread reads while replaying, so resizing and polling wait until it is
+    // idle, in flipDisplay()
+    std::deque<sf::Event> events_;
+    Vectoru pendingSize_;
+    bool resizePending_{false};
+
 public:
     Window(Vector<unsigned int> size, std::string caption = "");
     Window(Window const&) = delete;
@@ -41,11 +88,57 @@ public:
 
     virtual void flipDisplay();
 
+    /*!
+     * \brief Draws an SFML object, or records it for the render thread
+     *
+     * \param texture The sprite's texture, which is kept alive until the
+     *        sprite has been drawn
+     */
+    void draw(sf::Sprite const&, std::shared_ptr<Texture const> texture = nullptr);
+    void draw(sf::CircleShape const&);
+    void draw(sf::RectangleShape const&);
+    void draw(sf::ConvexShape const&);
+    /*!
+     * \brief Draws an SFML text object, or records it for the render thread
+     *
+     * \param font The text's font, which is kept alive until the text has
+     *        been drawn
+     */
+    void draw(sf::Text const&, std::shared_ptr<Font const> font = nullptr);
+
+    /*!
+     * \brief Sets the layer that following draw calls belong to
+     *
+     * Only used by the render thread, which draws recorded calls in layer
+     * order. World sets this before drawing each entity.
+     */
+    void setLayer(int layer)
+    {
+        recording_->setLayer(layer);
+    }
+
+    /*!
+     * \brief Starts or stops drawing on a separate thread
+     *
+     * \param threaded `true` to start the render thread
+     */
+    void setThreadedRendering(bool threaded);
+
+    bool isThreadedRendering() const
+    {
+        return renderThread_.joinable();
+    }
+
     virtual sf::RenderWindow& SFMLWindow()
     {
         return window_;
     }
 
+    /*!
+     * \brief Resizes the window
+     *
+     * With a render thread, the window is resized in the next flipDisplay().
+     */
     virtual void setSize(Vectoru size);
     virtual void setCaption(std::string caption);
 
@@ -54,6 +147,9 @@ public:
 
     /*!
      * \brief SFML-specific polling code (temporary)
+     *
+     * With a render thread, this returns the events gathered by the last
+     * flipDisplay().
      */
     bool pollEvent(sf::Event&);
 
@@ -61,6 +157,13 @@ public:
      * \brief Not implemented
      */
     virtual void setIcon(std::string path);
+
+private:
+    template <typename T>
+    void drawOrRecord(T const& drawable);
+
+    void render();
+    void applyResize();
 };
 }
 
@@ -6,6 +6,7 @@
 #include "World.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 #include <boost/range/algorithm.hpp>
@@ -13,12 +14,19 @@
 
 #include "Entity.hpp"
 #include "Game.hpp"
+#include "TypeTag.hpp"
+#include "../Utility/Profiler.hpp"
+#include "../Utility/ThreadPool.hpp"
 
 namespace tank
 {
 
 World::~World()
 {
+    // Scripts, timers and events may refer to entities, so go before them
+    scripts.clear();
+    timers_.clear();
+    bus_.clear();
     connections_.clear();
 }
 
@@ -29,13 +37,14 @@ void World::insertEntity(std::unique_ptr<Entity>&& entity)
     }
 
     // Stops an entity being added several times
-    if (boost::find(entities_, entity) != std::end(entities_)) {
+    if (isListed(entity.get())) {
         throw std::invalid_argument("Entity already added");
     }
 
     entity->setWorld(this);
     entity->onAdded();
-    entities_.push_back(std::move(entity));
+    entity->resetInterpolation();
+    listEntity(std::move(entity));
 }
 
 void World::moveEntity(observing_ptr<World> world, observing_ptr<Entity> entity)
@@ -66,7 +75,7 @@ void World::moveEntity(observing_ptr<World> world, observing_ptr<Entity> entity)
         return;
     }
 
-    toMove_.emplace_back(world, entity);
+    toMove_.emplace_back(world, entity->getHandle());
 
     // REVIEW: Ok so here's where updating_ is being checked!
     //         But, is this actually necessary? moveEntities() is going to get
@@ -78,29 +87,151 @@ void World::moveEntity(observing_ptr<World> world, observing_ptr<Entity> entity)
     }
 }
 
-std::unique_ptr<Entity> World::releaseEntity(observing_ptr<Entity> entity)
+void World::moveEntity(observing_ptr<World> world, EntityHandle entity)
 {
-    auto iter = boost::find(entities_, entity);
+    if (not entity) {
+        Game::log << "Warning: attempted to move destroyed entity."
+                  << std::endl;
+        return;
+    }
+
+    moveEntity(world, observing_ptr<Entity>(entity.get()));
+}
 
+std::unique_ptr<Entity> World::releaseEntity(observing_ptr<Entity> entity)
+{
     // REVIEW: Shouldn't this throw an exception?
     //         (Possibly std::invalid_argument)
-    if (iter == end(entities_)) {
+    if (not entity or not isListed(entity.get())) {
         return nullptr;
     }
 
-    auto ent = std::move(*iter);
-    entities_.erase(iter);
+    // The hole is closed by compactEntities(), keeping the entities' order
+    const std::size_t index = entity->worldIndex_;
+    auto ent = std::move(entities_[index]);
+    slots_[index] = EntityHandle::nullIndex;
+    ++holes_;
+
+    unlistEntity(ent.get());
     ent->onRemoved();
     return ent;
 }
 
+std::unique_ptr<Entity> World::releaseEntity(EntityHandle entity)
+{
+    return releaseEntity(observing_ptr<Entity>(entity.get()));
+}
+
+std::vector<Entity*> const& World::getEntitiesOfType(
+        std::string const& type) const
+{
+    std::size_t id;
+    return getEntitiesOfType(TypeTag::find(type, id) ? id : typeLists_.size());
+}
+
+std::vector<Entity*> const& World::getEntitiesOfType(std::size_t id) const
+{
+    static const std::vector<Entity*> none;
+    return id < typeLists_.size() ? typeLists_[id] : none;
+}
+
+observing_ptr<Entity> World::getEntity(EntityHandle entity) const
+{
+    Entity* ent = entity.get();
+    if (ent and isListed(ent)) {
+        return ent;
+    }
+    return nullptr;
+}
+
 void World::update()
 {
+    TANK_PROFILE_ZONE("World::update");
+
     // REVIEW: What is this? It's not thread safe or exception safe.
     updating_ = true;
 
+    // Close holes left by releases since the last update
+    if (holes_ > 0) {
+        compactEntities();
+    }
+
+    ++tick_;
+    updateFocusPoints();
+
+    // Phase one: concurrent, read-only logic
+    parallelEntities_.clear();
     for (auto& entity : entities_) {
-        entity->update();
+        if (not entity) {
+            continue;
+        }
+
+        // Most entities update every tick, and needn't be checked
+        if (entity->scheduled_) {
+            entity->due_ = isDue(entity.get());
+        }
+        if ((not entity->scheduled_ or entity->due_) and
+            entity->isParallel()) {
+            parallelEntities_.push_back(entity.get());
+        }
+    }
+
+    if (not parallelEntities_.empty()) {
+        TANK_PROFILE_ZONE("World::parallelUpdate");
+
+        // Entities may call collide() concurrently, which mustn't rehash
+        rehashMoved();
+
+        auto body = [this](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) {
+                parallelEntities_[i]->parallelUpdate();
+            }
+        };
+
+        if (parallel_) {
+            ThreadPool::shared().parallelFor(0, parallelEntities_.size(),
+                                             body, 16);
+        } else {
+            body(0, parallelEntities_.size());
+        }
+    }
+
+    // Phase two: everything else, in order
+    {
+        TANK_PROFILE_ZONE("World::updateEntities");
+        // Entities inserted during the update wait for the next one. The
+        // bounds are members so compactEntities() can move them.
+        updateNext_ = 0;
+        updateEnd_ = entities_.size();
+        while (updateNext_ < updateEnd_) {
+            Entity* entity = entities_[updateNext_++].get();
+            if (not entity) {
+                continue;
+            }
+
+            entity->resetInterpolation();
+            if (not entity->scheduled_ or entity->due_) {
+                entity->due_ = false;
+                entity->update();
+            }
+        }
+    }
+
+    {
+        TANK_PROFILE_ZONE("World::runTimers");
+        timers_.advance();
+    }
+
+    {
+        TANK_PROFILE_ZONE("World::runScripts");
+        scripts.run(tick_);
+    }
+
+    updateContacts();
+
+    {
+        TANK_PROFILE_ZONE("World::deliverEvents");
+        bus_.deliver();
     }
 
     addEntities();
@@ -109,30 +240,198 @@ void World::update()
     updating_ = false;
 }
 
+std::uint64_t World::toTicks(std::chrono::duration<double> time)
+{
+    const double ticks = time.count() * Game::fps;
+    const auto whole = static_cast<std::uint64_t>(ticks);
+    return whole < ticks ? whole + 1 : whole;
+}
+
+void World::addFocus(observing_ptr<Entity> entity)
+{
+    focus_.push_back(entity->getHandle());
+}
+
+void World::removeFocus(observing_ptr<Entity> entity)
+{
+    const EntityHandle handle = entity->getHandle();
+    focus_.erase(std::remove(focus_.begin(), focus_.end(), handle),
+                 focus_.end());
+}
+
+void World::updateFocusPoints()
+{
+    const Rectd view = camera.getViewBounds(Game::screenSize());
+    focusPoints_.assign(1, {view.x + view.w / 2, view.y + view.h / 2});
+
+    for (std::size_t i = 0; i < focus_.size();) {
+        if (Entity* entity = focus_[i].get()) {
+            focusPoints_.push_back(Vectord{entity->getPos()});
+            ++i;
+        } else {
+            // Destroyed entities stop being focus points
+            focus_.erase(focus_.begin() + i);
+        }
+    }
+}
+
+bool World::isDue(Entity* entity)
+{
+    if (entity->asleep_) {
+        return false;
+    }
+
+    // Stagger entities sharing an interval over the ticks between updates
+    UpdatePolicy const& policy = entity->updatePolicy_;
+    if (policy.interval > 1 and
+        (tick_ + static_cast<unsigned>(entity->actorID_)) % policy.interval) {
+        return false;
+    }
+
+    if (policy.radius < std::numeric_limits<double>::infinity()) {
+        const Vectord pos = entity->getPos();
+        const double radiusSq = policy.radius * policy.radius;
+        bool near = false;
+        for (auto const& point : focusPoints_) {
+            const Vectord offset = pos - point;
+            if (offset.x * offset.x + offset.y * offset.y <= radiusSq) {
+                near = true;
+                break;
+            }
+        }
+
+        // Out of range, time stands still
+        if (not near) {
+            entity->lastUpdate_ = tick_;
+            return false;
+        }
+    }
+
+    entity->elapsedTicks_ = static_cast<unsigned>(tick_ - entity->lastUpdate_);
+    entity->lastUpdate_ = tick_;
+    return true;
+}
+
 void World::draw()
 {
-    boost::stable_sort(entities_, [](std::unique_ptr<Entity> const& e1,
-                                     std::unique_ptr<Entity> const& e2) {
-        return e1->getLayer() < e2->getLayer();
+    TANK_PROFILE_ZONE("World::draw");
+
+    drawing_ = true;
+    viewBounds_ = camera.getViewBounds(Game::screenSize());
+    if (culling_ and cullMargin_ >= 0) {
+        drawIndexed();
+    } else {
+        drawLayers();
+    }
+    drawing_ = false;
+
+    // Layer changes made while drawing take effect from the next frame
+    for (auto const& change : relayered_) {
+        if (removeFromLayer(change.first, change.second)) {
+            addToLayer(change.first);
+        }
+    }
+    relayered_.clear();
+
+    for (auto iter = layers_.begin(); iter != layers_.end();) {
+        compactLayer(iter++);
+    }
+}
+
+void World::drawLayers()
+{
+    auto const& window = Game::window();
+
+    for (auto const& layer : layers_) {
+        if (window) {
+            window->setLayer(layer.first);
+        }
+
+        // Entities inserted while drawing are drawn next frame
+        auto const& entities = layer.second.entities;
+        const std::size_t count = entities.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            Entity* entity = entities[i];
+            if (not entity) {
+                continue;
+            }
+            if (not culling_ or inView(entity->getDrawBounds())) {
+                TANK_PROFILE_ZONE("Entity::draw");
+                entity->draw(camera);
+            } else {
+                entity->skipDraw();
+            }
+        }
+    }
+}
+
+void World::drawIndexed()
+{
+    auto const& window = Game::window();
+
+    // Entities with hitboxes near the view, put in draw order
+    const Rectd area = {viewBounds_.x - cullMargin_,
+                        viewBounds_.y - cullMargin_,
+                        viewBounds_.w + 2 * cullMargin_,
+                        viewBounds_.h + 2 * cullMargin_};
+    visible_.clear();
+    collisionCandidates(area, visible_);
+    std::sort(visible_.begin(), visible_.end(),
+              [](Entity const* a, Entity const* b) {
+        return a->layer_ < b->layer_ or
+               (a->layer_ == b->layer_ and a->layerIndex_ < b->layerIndex_);
     });
 
-    for (auto& entity : entities_) {
-        entity->draw(camera);
+    bool layerSet = false;
+    int layer = 0;
+    for (Entity* entity : visible_) {
+        if (window and (not layerSet or entity->layer_ != layer)) {
+            layer = entity->layer_;
+            layerSet = true;
+            window->setLayer(layer);
+        }
+
+        if (inView(entity->getDrawBounds())) {
+            TANK_PROFILE_ZONE("Entity::draw");
+            entity->draw(camera);
+        } else {
+            entity->skipDraw();
+        }
+    }
+
+    // Everything else is culled, but its animations still keep time.
+    // visible_ is in draw order, so it can be walked alongside the layers.
+    std::size_t next = 0;
+    for (auto const& layer : layers_) {
+        auto const& entities = layer.second.entities;
+        const std::size_t count = entities.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            Entity* entity = entities[i];
+            if (next < visible_.size() and visible_[next] == entity) {
+                ++next;
+            } else if (entity) {
+                entity->skipDraw();
+            }
+        }
     }
 }
 
 void World::addEntities()
 {
-    std::move(newEntities_.begin(), newEntities_.end(),
-              std::back_inserter(entities_));
+    TANK_PROFILE_ZONE("World::addEntities");
+    for (auto& entity : newEntities_) {
+        entity->resetInterpolation();
+        listEntity(std::move(entity));
+    }
     newEntities_.clear();
 }
 
 void World::moveEntities()
 {
+    TANK_PROFILE_ZONE("World::moveEntities");
     while (!toMove_.empty()) {
         observing_ptr<World> world = std::get<0>(toMove_.back());
-        observing_ptr<Entity> entity = std::get<1>(toMove_.back());
+        EntityHandle entity = std::get<1>(toMove_.back());
         toMove_.pop_back();
 
         std::unique_ptr<Entity> entPtr = releaseEntity(entity);
@@ -147,21 +446,534 @@ void World::moveEntities()
 
 void World::deleteEntities()
 {
-    boost::remove_erase_if(entities_, [](const std::unique_ptr<Entity>& ent) {
-        if (ent->isRemoved()) {
-            ent->onRemoved();
+    TANK_PROFILE_ZONE("World::deleteEntities");
+
+    // onRemoved() may fetch the entity list, which mustn't be compacted
+    // until both loops are done
+    bool removed = false;
+    deleting_ = true;
+    for (std::size_t i = 0; i < entities_.size(); ++i) {
+        Entity* entity = entities_[i].get();
+        if (entity and entity->isRemoved()) {
+            unlistEntity(entity);
+            entity->onRemoved();
+            if (entity->scriptCount_ > 0) {
+                scripts.cancel(entity->getHandle());
+            }
+            removed = true;
+        }
+    }
+    deleting_ = false;
+
+    if (not removed and holes_ == 0) {
+        return;
+    }
+
+    // Every removed entity is told before any is destroyed
+    for (auto& entity : entities_) {
+        if (entity and entity->isRemoved()) {
+            entity.reset();
+            ++holes_;
+        }
+    }
+    compactEntities();
+}
+
+void World::compactEntities()
+{
+    // Close the gaps left by removed and released entities, keeping order
+    std::size_t count = 0;
+    std::size_t next = updateNext_;
+    std::size_t end = updateEnd_;
+    for (std::size_t i = 0; i < entities_.size(); ++i) {
+        auto& entity = entities_[i];
+        if (not entity) {
+            // The update loop keeps its place
+            next -= i < updateNext_;
+            end -= i < updateEnd_;
+            continue;
+        }
+        entity->worldIndex_ = count;
+        if (count != i) {
+            // Its transform moves down with it, keeping the store packed
+            entity->moveTransform(transforms_, count);
+            slots_[count] = count;
+            sweep_.slots[entity->sweepIndex_] = count;
+        }
+        entities_[count++] = std::move(entity);
+    }
+    entities_.erase(entities_.begin() + count, entities_.end());
+    slots_.resize(count);
+    holes_ = 0;
+    updateNext_ = next;
+    updateEnd_ = end;
+}
+
+bool World::isListed(Entity const* entity) const
+{
+    const std::size_t index = entity->worldIndex_;
+    return entity->world_ == this and index < entities_.size() and
+           entities_[index].get() == entity;
+}
+
+void World::listEntity(std::unique_ptr<Entity>&& entity)
+{
+    entity->lastUpdate_ = tick_;
+    entity->worldIndex_ = entities_.size();
+    entity->moveTransform(transforms_, entities_.size());
+    addToLayer(entity.get());
+    addToTypeLists(entity.get());
+    entity->sweepIndex_ = sweep_.entities.size();
+    sweep_.entities.push_back(entity.get());
+    sweep_.slots.push_back(entity->getSlot());
+    sweep_.stale = true;
+    if (entity->collisionEvents_) {
+        ++collisionEvents_;
+    }
+    spatialHash_.insert(entity.get(), entity->getWorldHitbox(),
+                        entity->cells_);
+    slots_.push_back(entity->getSlot());
+    entities_.push_back(std::move(entity));
+}
+
+void World::unlistEntity(Entity* entity)
+{
+    // Don't leave a pointer to it in moved_
+    if (entity->boundsChanged_) {
+        rehashMoved();
+    }
+
+    removeFromLayer(entity, entity->getLayer());
+    removeFromTypeLists(entity);
+    spatialHash_.remove(entity, entity->cells_);
+
+    sweep_.entities[entity->sweepIndex_] = nullptr;
+    sweep_.stale = true;
+
+    if (entity->collisionEvents_) {
+        --collisionEvents_;
+    }
+    endContacts(entity);
+
+    entity->moveTransform(Transforms::unlisted(), entity->getHandle().index());
+}
+
+void World::setCellSize(double size)
+{
+    spatialHash_.setCellSize(size);
+    moved_.clear();
+    for (auto& entity : entities_) {
+        if (entity) {
+            entity->cells_ = {};
+            entity->boundsChanged_ = false;
+            spatialHash_.insert(entity.get(), entity->getWorldHitbox(),
+                                entity->cells_);
+        }
+    }
+}
+
+void World::boundsChanged(Entity* entity)
+{
+    sweep_.stale = true;
+
+    // Entities waiting to be added are hashed when they are
+    if (entity->cells_.stored and not entity->boundsChanged_) {
+        entity->boundsChanged_ = true;
+        moved_.push_back(entity);
+    }
+}
+
+void World::rehashMoved()
+{
+    for (Entity* entity : moved_) {
+        entity->boundsChanged_ = false;
+        spatialHash_.update(entity, entity->getWorldHitbox(), entity->cells_);
+    }
+    moved_.clear();
+}
+
+void World::collisionCandidates(Rectd const& bounds,
+                                std::vector<Entity*>& candidates)
+{
+    if (not moved_.empty()) {
+        rehashMoved();
+    }
+
+    spatialHash_.query(bounds, [&candidates](Entity* entity) {
+        candidates.push_back(entity);
+    });
+
+    // Same order as the entity list, without the duplicates from entities
+    // covering several cells
+    std::sort(candidates.begin(), candidates.end(),
+              [](Entity const* a, Entity const* b) {
+        return a->worldIndex_ < b->worldIndex_;
+    });
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+}
+
+void World::refreshSweep()
+{
+    if (not sweep_.stale) {
+        return;
+    }
+    sweep_.stale = false;
+
+    auto& entities = sweep_.entities;
+    auto& slots = sweep_.slots;
+    auto& minX = sweep_.minX;
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        if (entities[i]) {
+            slots[count] = slots[i];
+            entities[count++] = entities[i];
+        }
+    }
+    entities.resize(count);
+    slots.resize(count);
+    minX.resize(count);
+
+    // Entities whose hitboxes aren't numbers are sorted last, and never
+    // overlap anything
+    for (std::size_t i = 0; i < count; ++i) {
+        const Rectd box = transforms_.worldHitbox(slots[i]);
+        const double x = std::min(box.x, box.x + box.w);
+        minX[i] = x == x ? x : std::numeric_limits<double>::infinity();
+    }
+
+    // Last tick's order is nearly sorted, so insertion sort is close to
+    // linear. If entities have jumped around, give up and sort properly.
+    std::size_t budget = 4 * count + 256;
+    for (std::size_t i = 1; i < count and budget > 0; ++i) {
+        Entity* entity = entities[i];
+        const std::uint32_t slot = slots[i];
+        const double x = minX[i];
+        std::size_t j = i;
+        for (; j > 0 and minX[j - 1] > x and budget > 0; --j, --budget) {
+            entities[j] = entities[j - 1];
+            slots[j] = slots[j - 1];
+            minX[j] = minX[j - 1];
+        }
+        entities[j] = entity;
+        slots[j] = slot;
+        minX[j] = x;
+    }
+    if (budget == 0) {
+        std::vector<std::size_t> order(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&minX](std::size_t a, std::size_t b) {
+            return minX[a] < minX[b];
+        });
+
+        std::vector<Entity*> sortedEntities(count);
+        std::vector<std::uint32_t> sortedSlots(count);
+        std::vector<double> sortedMinX(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            sortedEntities[i] = entities[order[i]];
+            sortedSlots[i] = slots[order[i]];
+            sortedMinX[i] = minX[order[i]];
+        }
+        entities.swap(sortedEntities);
+        slots.swap(sortedSlots);
+        minX.swap(sortedMinX);
+    }
+
+    sweep_.maxX.resize(count);
+    sweep_.minY.resize(count);
+    sweep_.maxY.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Rectd box = transforms_.worldHitbox(slots[i]);
+        if (minX[i] == std::numeric_limits<double>::infinity() or
+            box.y != box.y or box.h != box.h) {
+            sweep_.maxX[i] = -std::numeric_limits<double>::infinity();
+            sweep_.minY[i] = std::numeric_limits<double>::infinity();
+            sweep_.maxY[i] = -std::numeric_limits<double>::infinity();
+        } else {
+            sweep_.maxX[i] = std::max(box.x, box.x + box.w);
+            sweep_.minY[i] = std::min(box.y, box.y + box.h);
+            sweep_.maxY[i] = std::max(box.y, box.y + box.h);
+        }
+    }
+
+    sweep_.types.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        entities[i]->sweepIndex_ = i;
+        sweep_.types[i] = entities[i]->typeMask_;
+    }
+}
+
+void World::updateContacts()
+{
+    if (collisionEvents_ == 0 and contacts_.empty()) {
+        return;
+    }
+
+    TANK_PROFILE_ZONE("World::updateContacts");
+
+    nextContacts_.clear();
+    if (collisionEvents_ > 0) {
+        forEachOverlappingPair(TypeTag::allTypes, TypeTag::allTypes,
+                               [this](Entity& a, Entity& b) {
+            if (not a.collisionEvents_ and not b.collisionEvents_) {
+                return;
+            }
+            Entity* first = &a;
+            Entity* second = &b;
+            if (second->actorID_ < first->actorID_) {
+                std::swap(first, second);
+            }
+            nextContacts_.push_back({first->actorID_, second->actorID_,
+                                     first->handle_, second->handle_, false,
+                                     false});
+        });
+        std::sort(nextContacts_.begin(), nextContacts_.end(), contactBefore);
+    }
+
+    // Pairs that carry on keep track of who has been told; the rest end
+    std::vector<Contact> ended;
+    auto next = nextContacts_.begin();
+    for (auto const& contact : contacts_) {
+        while (next != nextContacts_.end() and contactBefore(*next, contact)) {
+            beginContact(*next);
+            ++next;
+        }
+
+        if (next != nextContacts_.end() and
+            not contactBefore(contact, *next)) {
+            next->firstBegun = contact.firstBegun;
+            next->secondBegun = contact.secondBegun;
+            ++next;
+        } else {
+            --contact.first->contactCount_;
+            --contact.second->contactCount_;
+            ended.push_back(contact);
+        }
+    }
+    for (; next != nextContacts_.end(); ++next) {
+        beginContact(*next);
+    }
+    contacts_.swap(nextContacts_);
+
+    fireContactEnds(ended);
+
+    // Hooks may release entities, which removes their contacts from the
+    // list, so work from a copy and look each contact up again before every
+    // call
+    beginning_.clear();
+    for (auto const& contact : contacts_) {
+        if (not contact.firstBegun or not contact.secondBegun) {
+            beginning_.push_back(contact);
+        }
+    }
+
+    for (auto const& pending : beginning_) {
+        Contact* contact = findContact(pending);
+        if (contact and not contact->firstBegun and
+            contact->first->collisionEvents_) {
+            contact->firstBegun = true;
+            contact->first->onCollisionBegin(*contact->second);
+        }
+
+        contact = findContact(pending);
+        if (contact and not contact->secondBegun and
+            contact->second->collisionEvents_) {
+            contact->secondBegun = true;
+            contact->second->onCollisionBegin(*contact->first);
+        }
+    }
+}
+
+bool World::contactBefore(Contact const& a, Contact const& b)
+{
+    return a.firstID < b.firstID or
+           (a.firstID == b.firstID and a.secondID < b.secondID);
+}
+
+World::Contact* World::findContact(Contact const& contact)
+{
+    // Removing contacts keeps the rest in order
+    auto found = std::lower_bound(contacts_.begin(), contacts_.end(), contact,
+                                  contactBefore);
+    if (found == contacts_.end() or contactBefore(contact, *found) or
+        found->first != contact.first or found->second != contact.second) {
+        return nullptr;
+    }
+    return &*found;
+}
+
+void World::beginContact(Contact const& contact)
+{
+    ++contact.first->contactCount_;
+    ++contact.second->contactCount_;
+    contact.first->wake();
+    contact.second->wake();
+}
+
+void World::endContacts(Entity* entity)
+{
+    if (entity->contactCount_ == 0) {
+        return;
+    }
+
+    std::vector<Contact> ended;
+    auto end = std::remove_if(contacts_.begin(), contacts_.end(),
+                              [entity, &ended](Contact const& contact) {
+        if (contact.first.get() == entity or contact.second.get() == entity) {
+            --contact.first->contactCount_;
+            --contact.second->contactCount_;
+            ended.push_back(contact);
             return true;
         }
         return false;
     });
+    contacts_.erase(end, contacts_.end());
+
+    fireContactEnds(ended);
+}
+
+void World::fireContactEnds(std::vector<Contact> const& ended)
+{
+    // An entity released by an earlier hook may have been destroyed
+    for (auto const& contact : ended) {
+        Entity* first = contact.first.get();
+        Entity* second = contact.second.get();
+        if (not first or not second) {
+            continue;
+        }
+
+        if (contact.firstBegun) {
+            first->onCollisionEnd(*second);
+        }
+        if (contact.secondBegun and contact.first.isValid() and
+            contact.second.isValid()) {
+            second->onCollisionEnd(*first);
+        }
+    }
+}
+
+void World::collisionEventsChanged(Entity* entity)
+{
+    // Contacts are found, begun and ended in the next update
+    if (entity->collisionEvents_) {
+        ++collisionEvents_;
+    } else {
+        --collisionEvents_;
+    }
+}
+
+void World::addToTypeLists(Entity* entity, std::size_t first)
+{
+    for (std::size_t i = first; i < entity->typeIds_.size(); ++i) {
+        const std::size_t id = entity->typeIds_[i];
+        if (id >= typeLists_.size()) {
+            typeLists_.resize(id + 1);
+        }
+        entity->typeSlots_[i] = typeLists_[id].size();
+        typeLists_[id].push_back(entity);
+    }
+    sweep_.stale = true;
+}
+
+void World::removeFromTypeLists(Entity* entity)
+{
+    sweep_.stale = true;
+    for (std::size_t i = 0; i < entity->typeIds_.size(); ++i) {
+        const std::size_t id = entity->typeIds_[i];
+        auto& list = typeLists_[id];
+        const std::size_t slot = entity->typeSlots_[i];
+
+        // The last entity in the list takes its place
+        Entity* last = list.back();
+        list[slot] = last;
+        list.pop_back();
+        if (last != entity) {
+            for (std::size_t j = 0; j < last->typeIds_.size(); ++j) {
+                if (last->typeIds_[j] == id) {
+                    last->typeSlots_[j] = slot;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void World::addToLayer(Entity* entity)
+{
+    auto& entities = layers_[entity->getLayer()].entities;
+    entity->layerIndex_ = entities.size();
+    entities.push_back(entity);
+}
+
+bool World::removeFromLayer(Entity* entity, int layer)
+{
+    auto iter = layers_.find(layer);
+    if (iter == layers_.end()) {
+        return false;
+    }
+
+    auto& entities = iter->second.entities;
+    const std::size_t index = entity->layerIndex_;
+    if (index >= entities.size() or entities[index] != entity) {
+        return false;
+    }
+
+    entities[index] = nullptr;
+    ++iter->second.holes;
+    if (not drawing_) {
+        compactLayer(iter);
+    }
+    return true;
+}
+
+void World::compactLayer(std::map<int, Layer>::iterator iter)
+{
+    Layer& layer = iter->second;
+    if (layer.holes == layer.entities.size()) {
+        layers_.erase(iter);
+        return;
+    }
+
+    // Compacting only once half the layer is empty keeps removal O(1)
+    // amortized
+    if (layer.holes * 2 <= layer.entities.size()) {
+        return;
+    }
+
+    std::size_t count = 0;
+    for (Entity* entity : layer.entities) {
+        if (entity) {
+            entity->layerIndex_ = count;
+            layer.entities[count++] = entity;
+        }
+    }
+    layer.entities.resize(count);
+    layer.holes = 0;
+}
+
+void World::layerChanged(Entity* entity, int oldLayer)
+{
+    if (drawing_) {
+        relayered_.emplace_back(entity, oldLayer);
+        return;
+    }
+
+    // Entities waiting to be added aren't in a layer yet
+    if (removeFromLayer(entity, oldLayer)) {
+        addToLayer(entity);
+    }
 }
 
 tank::observing_ptr<tank::EventHandler::Connection>
         World::connect(EventHandler::Condition condition,
                        EventHandler::Effect effect)
 {
-    auto cond = eventHandler.connect(condition, effect);
-    connections_.push_back(std::move(cond));
+    connections_.emplace_back(new EventHandler::Connection{
+            eventHandler.connect(std::move(condition), std::move(effect))});
     return connections_.back();
 }
 }
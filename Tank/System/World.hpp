@@ -6,13 +6,20 @@
 #ifndef TANK_GAMESTATE_HPP
 #define TANK_GAMESTATE_HPP
 
+#include <chrono>
+#include <map>
 #include <vector>
 #include <tuple>
 #include <memory>
+#include <utility>
 
 #include "Camera.hpp"
 #include "EventHandler.hpp"
 #include "Entity.hpp"
+#include "EventBus.hpp"
+#include "ScriptScheduler.hpp"
+#include "../Utility/SpatialHash.hpp"
+#include "../Utility/TimingWheel.hpp"
 #include "../Utility/Vector.hpp"
 #include "../Utility/observing_ptr.hpp"
 
@@ -49,14 +56,96 @@ public:
     /*! \brief The world's EventHandler */
     EventHandler eventHandler;
     Camera camera;
+    /*! \brief The world's scripts, resumed each tick; see runScript() */
+    ScriptScheduler scripts;
 
 private:
+    // Entities leaving a layer leave a null behind, which is compacted away
+    // once enough have built up
+    struct Layer
+    {
+        std::vector<Entity*> entities;
+        std::size_t holes {0};
+    };
+
     bool updating_ {false};
-    std::vector<std::tuple<observing_ptr<World>, observing_ptr<Entity>>>
-            toMove_;
+    bool parallel_ {true};
+    std::uint64_t tick_ {0};
+    TimingWheel timers_;
+    EventBus bus_;
+    // Null entries in entities_, the part of it the update loop has left to
+    // go through, and whether deleteEntities() is holding off compaction
+    std::size_t holes_ {0};
+    std::size_t updateNext_ {0};
+    std::size_t updateEnd_ {0};
+    bool deleting_ {false};
+    std::vector<Entity*> parallelEntities_;
+    std::vector<std::tuple<observing_ptr<World>, EntityHandle>> toMove_;
     std::vector<std::unique_ptr<Entity>> newEntities_;
     std::vector<std::unique_ptr<EventHandler::Connection>> connections_;
 
+    // Draw order: entities by layer, in the order they joined each layer
+    std::map<int, Layer> layers_;
+    std::vector<std::pair<Entity*, int>> relayered_;
+    bool drawing_ {false};
+    float alpha_ {1.f};
+
+    // Entities that UpdatePolicy radii are measured from, besides the
+    // camera, and where they all were at the start of this tick
+    std::vector<EntityHandle> focus_;
+    std::vector<Vectord> focusPoints_;
+
+    // What the camera shows, worked out at the start of each draw
+    Rectd viewBounds_;
+    bool culling_ {true};
+    double cullMargin_ {-1};
+    std::vector<Entity*> visible_;
+
+    // Every listed entity, by hitbox. Entities that have moved are rehashed
+    // in a batch when the hash is next needed.
+    SpatialHash<Entity> spatialHash_;
+    std::vector<Entity*> moved_;
+
+    // Listed entities of each type, by TypeTag id, in no particular order
+    std::vector<std::vector<Entity*>> typeLists_;
+
+    // Every listed entity, sorted on the left edge of its hitbox, for
+    // forEachOverlappingPair(). The bounds and types are kept in arrays of
+    // their own, in the same order, so the sweep reads them contiguously.
+    // Released entities leave a null behind until the next refresh.
+    struct Sweep
+    {
+        std::vector<Entity*> entities;
+        std::vector<std::uint32_t> slots;
+        std::vector<double> minX;
+        std::vector<double> maxX;
+        std::vector<double> minY;
+        std::vector<double> maxY;
+        std::vector<TypeTag::Mask> types;
+        bool stale {false};
+    };
+    Sweep sweep_;
+
+    // Overlapping pairs with at least one entity that has collision events,
+    // sorted by actor ID, and whether each entity has been told the pair
+    // began. Both entities are always listed.
+    struct Contact
+    {
+        int firstID;
+        int secondID;
+        EntityHandle first;
+        EntityHandle second;
+        bool firstBegun;
+        bool secondBegun;
+    };
+    std::vector<Contact> contacts_;
+    std::vector<Contact> nextContacts_;
+    std::vector<Contact> beginning_; // Contacts with begin hooks to call
+    std::size_t collisionEvents_ {0}; // Listed entities with them turned on
+
+    friend class Entity;
+    friend class Game;
+
 public:
     /*!
      * \brief Creates an Entity to be added to the world at the beginning of the
@@ -65,8 +154,8 @@ public:
      * This is a factory function which creates an instance of a class deriving
      * from Entity. The entity is constructed immediately, passing the `args`
      * provided. The entity's world pointer is then set, and Entity.onAdded()
-     * is called. At the beginning of the next frame, the entity is added to the
-     * entity list.
+     * is called. At the end of the current update (or the next one, if the
+     * world isn't updating), the entity is added to the entity list.
      *
      * Example code:
      *
@@ -83,10 +172,11 @@ public:
      *
      * \tparam T The type of entity to create.
      * \param args Arguments to pass to T's constructor.
-     * \return An observing_ptr of type T to the newly created World
+     * \return A Handle to the new entity, which converts to an observing_ptr
+     *         of type T
      */
     template <typename T, typename... Args>
-    observing_ptr<T> makeEntity(Args&&... args);
+    Handle<T> makeEntity(Args&&... args);
 
     virtual void onAdded() {}
 
@@ -115,18 +205,69 @@ public:
      */
     void moveEntity(observing_ptr<World>, observing_ptr<Entity>);
 
+    /*!
+     * \brief Moves an Entity from one world to another
+     *
+     * Does nothing if the entity has already been destroyed.
+     *
+     * \param world The world to which to move the entity
+     * \param entity A handle to the entity to be moved
+     */
+    void moveEntity(observing_ptr<World>, EntityHandle);
+
     /*!
      * \brief Removes an Entity from the entity list and returns it
      *
+     * This takes constant time: the released entity's place is left empty,
+     * and the hole is closed, keeping the other entities in order, at the
+     * start of the next update() or the next call to getEntities().
+     *
      * \param entity An observing_ptr pointer to the entity to be released
+     * \return The entity, or `nullptr` if it isn't in this world's list
      * \see insertEntity()
      */
     std::unique_ptr<Entity> releaseEntity(observing_ptr<Entity>);
 
+    /*!
+     * \brief Removes an Entity from the entity list and returns it
+     *
+     * \param entity A handle to the entity to be released
+     * \return The entity, or `nullptr` if it has been destroyed or isn't in
+     *         this world's list
+     */
+    std::unique_ptr<Entity> releaseEntity(EntityHandle);
+
+    /*!
+     * \brief Looks up an entity in the entity list
+     *
+     * \param entity A handle to the entity
+     * \return The entity, or `nullptr` if it has been destroyed or isn't in
+     *         this world's list (entities made with makeEntity() join the list
+     *         at the end of an update)
+     */
+    observing_ptr<Entity> getEntity(EntityHandle entity) const;
+
     /*!
      * \brief Update all Entity instances in the entity list
      *
-     * Game calls this on the current world once per frame, before calling draw().
+     * Game calls this on the current world once per tick, before calling
+     * draw(). With Game::fixedTimestep set this happens Game::fps times per
+     * second, however often the world is drawn.
+     *
+     * An update happens in two phases. First, Entity.parallelUpdate() is
+     * called on every entity marked with Entity.setParallel(), spread across
+     * ThreadPool::shared(). Then Entity.update() is called on every entity in
+     * turn.
+     *
+     * Both phases skip entities that are asleep, or whose
+     * Entity.setUpdatePolicy() doesn't call for an update this tick. After the
+     * second phase, callbacks from after() and every() that are due are
+     * called, and scripts whose waits are over are resumed.
+     *
+     * After that, if any entity has Entity.setCollisionEvents() turned on,
+     * the world finds which pairs of entities have started or stopped
+     * overlapping and calls Entity.onCollisionBegin() or
+     * Entity.onCollisionEnd() on them.
      *
      * Override this to add frame logic specific to the world, but be sure to
      * update the entity list by calling World.update().
@@ -142,38 +283,412 @@ public:
      * When world is the active World, the game loop calls this once per
      * iteration, after update().
      *
-     * By default, it will sort the entity list by Entity.getLayer() before
-     * drawing.
+     * By default, entities are drawn in order of Entity.getLayer(), and within
+     * a layer in the order they were added to the world or moved to that
+     * layer. The world keeps this order as entities are added, removed and
+     * change layer, so nothing is sorted while drawing, and the entity list
+     * itself stays in the order entities were added.
      *
      * Override this to specify new behaviour when drawing the entire world each
-     * frame, *e.g.* to sort the entity list some other way, but be sure to then
+     * frame, *e.g.* to order the entities some other way, but be sure to then
      * draw all entities by either calling
      * World.draw() or looping over the entities list:
      *
      * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
-     * for (auto& e : entities_) {
+     * for (auto& e : getEntities()) {
      *     e->draw(camera);
      * }
      * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
      *
+     * Unless culling is turned off, entities outside the camera's view are
+     * skipped.
+     *
      * \see update()
      * \see Game
+     * \see getAlpha()
+     * \see setCulling()
      */
     virtual void draw();
 
+    /*!
+     * \brief Returns how far the game is between the last tick and the next,
+     * from 0 to 1
+     *
+     * Game sets this for the duration of each draw(), and it is 1 at any
+     * other time. Entity.draw() draws entities this far between their
+     * positions at the start and end of the last tick.
+     */
+    float getAlpha() const
+    {
+        return alpha_;
+    }
+
+    /*!
+     * \brief Sets whether Entity.parallelUpdate() calls are run across
+     * ThreadPool::shared()
+     *
+     * If not, they are run one after another on the calling thread, which can
+     * be handy when debugging. Either way, they all finish before any
+     * Entity.update() starts.
+     *
+     * \param parallel `false` to run the parallel phase serially
+     */
+    void setParallel(bool parallel)
+    {
+        parallel_ = parallel;
+    }
+
+    bool isParallel() const
+    {
+        return parallel_;
+    }
+
+    /*!
+     * \brief Measures UpdatePolicy radii from an entity, as well as from the
+     * middle of the camera's view
+     *
+     * \param entity The entity, typically the player
+     * \see Entity.setUpdatePolicy()
+     */
+    void addFocus(observing_ptr<Entity> entity);
+
+    /*!
+     * \brief Stops measuring UpdatePolicy radii from an entity
+     */
+    void removeFocus(observing_ptr<Entity> entity);
+
+    /*!
+     * \brief Returns the number of times update() has been called
+     */
+    std::uint64_t getTicks() const
+    {
+        return tick_;
+    }
+
+    /*!
+     * \brief Returns the number of ticks in a length of time, rounded up, at
+     * Game::fps ticks a second
+     */
+    static std::uint64_t toTicks(std::chrono::duration<double> time);
+
+    /*!
+     * \brief Calls f once, after a delay
+     *
+     * The delay is rounded up to whole ticks, and f is called during
+     * update(), after Entity.update(). However many callbacks are waiting,
+     * they cost nothing until they are due.
+     *
+     * Callbacks belong to the world, not to any entity, and aren't cancelled
+     * when an entity is destroyed. Capture a Handle, which goes null with its
+     * entity, rather than a pointer or observing_ptr:
+     *
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+     *     tank::Handle<Bomb> bomb = world.makeEntity<Bomb>(pos);
+     *     auto fuse = world.after(std::chrono::seconds(3), [bomb] {
+     *         if (bomb) {
+     *             bomb->explode();
+     *         }
+     *     });
+     *     // ... defused
+     *     world.cancel(fuse);
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *
+     * \param delay How long to wait, at least one tick
+     * \param f The function to call
+     * \return A handle to pass to cancel()
+     * \see TimingWheel
+     */
+    template <typename Rep, typename Period>
+    TimerHandle after(std::chrono::duration<Rep, Period> delay,
+                      TimingWheel::Callback f)
+    {
+        return timers_.after(toTicks(delay), std::move(f));
+    }
+
+    /*!
+     * \brief Calls f repeatedly, until cancelled
+     *
+     * As with after(), f outlives the entities it refers to, so should hold
+     * Handles to them and stop when they are gone.
+     *
+     * \param period How long between calls, at least one tick
+     * \param f The function to call
+     * \return A handle to pass to cancel()
+     */
+    template <typename Rep, typename Period>
+    TimerHandle every(std::chrono::duration<Rep, Period> period,
+                      TimingWheel::Callback f)
+    {
+        return timers_.every(toTicks(period), std::move(f));
+    }
+
+    /*!
+     * \brief Stops a callback from after() or every() being called again
+     *
+     * \return `false` if it had already been called or cancelled
+     */
+    bool cancel(TimerHandle timer)
+    {
+        return timers_.cancel(timer);
+    }
+
+    /*!
+     * \brief Returns whether a callback from after() or every() is waiting
+     * to be called
+     */
+    bool isPending(TimerHandle timer) const
+    {
+        return timers_.isPending(timer);
+    }
+
+    /*!
+     * \brief Queues an event for the functions subscribed to its type
+     *
+     * Events are delivered in update(), after scripts run and contacts are
+     * found, and before entities are added, moved and removed. Events emitted
+     * while delivering wait for the next update().
+     *
+     * The bus isn't locked, so this and subscribe() must only be called from
+     * the thread running update(): never from Entity.parallelUpdate().
+     *
+     * \see EventBus
+     */
+    template <typename T>
+    void emit(T event)
+    {
+        bus_.emit(std::move(event));
+    }
+
+    /*!
+     * \brief Calls handler with each event of type T emitted in this world,
+     * until the returned subscription is destroyed
+     *
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+     *     struct PickedUp { int points; };
+     *
+     *     // In a score display entity's onAdded()
+     *     sub_ = getWorld()->subscribe<PickedUp>(
+     *             [this](PickedUp const& p) { score_ += p.points; });
+     *
+     *     // In a pickup's update()
+     *     getWorld()->emit(PickedUp{10});
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *
+     * Unlike an EventHandler condition, a subscriber costs nothing in frames
+     * where no event of its type is emitted.
+     */
+    template <typename T>
+    EventBus::Subscription subscribe(EventBus::Handler<T> handler)
+    {
+        return bus_.subscribe<T>(std::move(handler));
+    }
+
+    /*!
+     * \brief Sets the size of the cells the world sorts hitboxes into
+     *
+     * Entity.collide() only tests entities sharing a cell, so this is best set
+     * a little larger than a typical hitbox. Entities covering more than 64
+     * cells are tested by every collide() call.
+     *
+     * \param size The width and height of a cell, 64 by default
+     */
+    void setCellSize(double size);
+
+    double getCellSize() const
+    {
+        return spatialHash_.getCellSize();
+    }
+
+    /*!
+     * \brief Sets whether draw() skips entities and graphics the camera
+     * can't see
+     *
+     * Culling is on by default. Each frame, draw() works out the area of the
+     * world the camera shows and only draws entities whose
+     * Entity.getDrawBounds() overlap it, and of those, only the graphics
+     * inside it. Culled graphics have Graphic.skipDraw() called instead, so
+     * animations keep playing, and their callbacks fire, out of view.
+     *
+     * \param culling `false` to draw every entity
+     * \see setCullMargin()
+     */
+    void setCulling(bool culling)
+    {
+        culling_ = culling;
+    }
+
+    bool isCulling() const
+    {
+        return culling_;
+    }
+
+    /*!
+     * \brief Lets draw() look up the entities in view in the spatial hash,
+     * rather than checking every entity
+     *
+     * This only finds entities by their hitboxes, so the margin must be at
+     * least as far as any entity's graphics reach outside its hitbox; any
+     * further out aren't drawn. In a large level with little of it in view,
+     * this makes drawing cost depend on what's visible, not the level size.
+     *
+     * \param margin How far graphics reach outside hitboxes, or a negative
+     *        number (the default) to check every entity
+     */
+    void setCullMargin(double margin)
+    {
+        cullMargin_ = margin;
+    }
+
+    double getCullMargin() const
+    {
+        return cullMargin_;
+    }
+
+    /*!
+     * \brief Returns the area of the world the camera showed in the last
+     * draw()
+     */
+    Rectd getViewBounds() const
+    {
+        return viewBounds_;
+    }
+
+    /*!
+     * \brief Calls f once for every pair of entities in the entity list whose
+     * hitboxes overlap or touch, where one has typeA and the other typeB
+     *
+     * f is called as `f(a, b)`, with `a` an Entity& of typeA and `b` one of
+     * typeB. Each pair is visited once, even if both entities have both
+     * types, so this does half the work of calling Entity.collide() from
+     * every entity:
+     *
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+     *     world.forEachOverlappingPair("bullet", "enemy",
+     *                                  [](Entity& bullet, Entity& enemy) {
+     *         bullet.remove();
+     *         enemy.remove();
+     *     });
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *
+     * The world keeps its entities sorted on the left edge of their
+     * hitboxes, and sweeps across them. The order is kept between calls and
+     * touched up only when something has moved, which is cheap as entities
+     * move little each tick; calling this several times in a tick sorts at
+     * most once.
+     *
+     * f may remove, add or release entities, or move them: entities released
+     * by f aren't visited again, but otherwise the pairs are those overlapping
+     * when the call began. f mustn't call forEachOverlappingPair().
+     *
+     * \param typeA The type of the first entity in each pair
+     * \param typeB The type of the second entity in each pair
+     * \param f A function taking two Entity&
+     * \see Entity.collide()
+     */
+    template <typename F>
+    void forEachOverlappingPair(std::string const& typeA,
+                                std::string const& typeB, F f);
+
+    /*!
+     * \brief Calls f once for every pair of overlapping entities, where one
+     * has any of typeA and the other any of typeB
+     *
+     * \param typeA Types of the first entity in each pair, from
+     *        TypeTag::mask(), or TypeTag::allTypes
+     * \param typeB Types of the second entity in each pair
+     * \param f A function taking two Entity&
+     */
+    template <typename F>
+    void forEachOverlappingPair(TypeTag::Mask typeA, TypeTag::Mask typeB,
+                                F f);
+
+    /*!
+     * \brief Returns every entity in the entity list with a given type
+     *
+     * The world keeps a list for each type as entities are added, removed
+     * and change type, so this costs nothing however many entities there are.
+     * The entities are in no particular order.
+     *
+     * The list changes when the entity list or an entity's types do, so copy
+     * it before doing either while looping over it.
+     *
+     * \param type The type to look for
+     * \return A reference to the list of entities with type
+     * \see Entity.setType()
+     */
+    std::vector<Entity*> const& getEntitiesOfType(
+            std::string const& type) const;
+
+    /*!
+     * \brief Returns every entity in the entity list with a given type
+     *
+     * \param id The TypeTag id of the type to look for
+     */
+    std::vector<Entity*> const& getEntitiesOfType(std::size_t id) const;
+
     // TODO: This function is really unclear. Will have a further look later
     Vectorf worldFromScreenCoords(Vectorf const& screenCoords)
     {
         return camera.worldFromScreenCoords(screenCoords);
     }
 
+    /*!
+     * \brief Returns the Transforms slot of each entity in the entity list,
+     * in the same order
+     *
+     * Systems working on many entities' positions or hitboxes can loop over
+     * this instead of the entities themselves, reading packed arrays from
+     * getTransforms(). Slots of released entities are
+     * EntityHandle::nullIndex until the next update(), or the next call to
+     * getEntities(), which move the entities after them down.
+     *
+     * \see Transforms
+     * \see markMoved()
+     */
+    std::vector<std::uint32_t> const& getSlots() const
+    {
+        return slots_;
+    }
+
+    /*!
+     * \brief Returns the transforms of the entities in the entity list
+     *
+     * \see getSlots()
+     */
+    Transforms& getTransforms()
+    {
+        return transforms_;
+    }
+
+    /*!
+     * \brief Tells the world that an entity's position or hitbox was changed
+     * through Transforms, rather than Entity.setPos() or Entity.setHitbox()
+     *
+     * \param index The entity's place in the entity list (and getSlots())
+     */
+    void markMoved(std::size_t index)
+    {
+        if (Entity* entity = entities_[index].get()) {
+            boundsChanged(entity);
+        }
+    }
+
     /*!
      * \brief Returns the entity list
      *
+     * Entities are in the order they were added, which is also the order
+     * they are updated in. The list never holds null, but entities released
+     * while looping over it leave null in their place until it is next
+     * fetched. Fetched from Entity.onRemoved() while removed entities are
+     * being deleted, it may hold null too.
+     *
      * \return A reference to the list of unique_ptrs to entities
      */
     virtual const std::vector<std::unique_ptr<Entity>>& getEntities()
     {
+        if (holes_ > 0 and not deleting_) {
+            compactEntities();
+        }
         return entities_;
     }
 
@@ -206,19 +721,64 @@ public:
             connect(tank::EventHandler::Condition condition,
                     tank::EventHandler::Effect effect);
 
-protected:
-    /*! \brief list of Entity instances in the World */
-    // TODO: Make private and add getter
+private:
+    // The listed entities' transforms, at their place in entities_.
+    // Declared first so that it outlives them.
+    Transforms transforms_;
+    // Entities in the order they were added. Released entities leave a null
+    // behind, until compactEntities().
     std::vector<std::unique_ptr<Entity>> entities_;
+    // Transforms slot of each entity in entities_, or EntityHandle::nullIndex
+    std::vector<std::uint32_t> slots_;
 
-private:
     void addEntities();
     void moveEntities();
     void deleteEntities();
+    void compactEntities();
+
+    bool isListed(Entity const* entity) const;
+    void listEntity(std::unique_ptr<Entity>&& entity);
+    void unlistEntity(Entity* entity);
+
+    void boundsChanged(Entity* entity);
+    void rehashMoved();
+    void collisionCandidates(Rectd const& bounds,
+                             std::vector<Entity*>& candidates);
+
+    void refreshSweep();
+
+    void updateContacts();
+    void beginContact(Contact const& contact);
+    static bool contactBefore(Contact const& a, Contact const& b);
+    Contact* findContact(Contact const& contact);
+    void endContacts(Entity* entity);
+    void fireContactEnds(std::vector<Contact> const& ended);
+    void collisionEventsChanged(Entity* entity);
+
+    void addToTypeLists(Entity* entity, std::size_t first = 0);
+    void removeFromTypeLists(Entity* entity);
+
+    void addToLayer(Entity* entity);
+    bool removeFromLayer(Entity* entity, int layer);
+    void compactLayer(std::map<int, Layer>::iterator layer);
+    void layerChanged(Entity* entity, int oldLayer);
+
+    void updateFocusPoints();
+    bool isDue(Entity* entity);
+
+    void drawLayers();
+    void drawIndexed();
+    bool inView(Rectd const& bounds) const
+    {
+        return bounds.x <= viewBounds_.x + viewBounds_.w and
+               viewBounds_.x <= bounds.x + bounds.w and
+               bounds.y <= viewBounds_.y + viewBounds_.h and
+               viewBounds_.y <= bounds.y + bounds.h;
+    }
 };
 
 template <typename T, typename... Args>
-observing_ptr<T> World::makeEntity(Args&&... args)
+Handle<T> World::makeEntity(Args&&... args)
 {
     static_assert(std::is_base_of<Entity, T>::value,
                   "Type must derive from Entity");
@@ -228,9 +788,83 @@ observing_ptr<T> World::makeEntity(Args&&... args)
     std::unique_ptr<T> ent{new T(std::forward<Args>(args)...)};
     ent->setWorld(this);
     ent->onAdded();
-    observing_ptr<T> ptr{ent};
+    Handle<T> handle{ent->getHandle()};
     newEntities_.push_back(std::move(ent));
-    return ptr;
+    return handle;
+}
+
+template <typename F>
+void World::forEachOverlappingPair(std::string const& typeA,
+                                   std::string const& typeB, F f)
+{
+    const TypeTag::Query a = TypeTag::query(typeA);
+    const TypeTag::Query b = TypeTag::query(typeB);
+    if (a.overflow.empty() and b.overflow.empty()) {
+        forEachOverlappingPair(a.mask, b.mask, f);
+        return;
+    }
+
+    // Types sharing TypeTag::overflowBit are told apart here, so a pair the
+    // masks put the wrong way round may need swapping
+    forEachOverlappingPair(a.mask, b.mask, [&](Entity& first, Entity& second) {
+        if (first.isType(a) and second.isType(b)) {
+            f(first, second);
+        } else if (second.isType(a) and first.isType(b)) {
+            f(second, first);
+        }
+    });
+}
+
+template <typename F>
+void World::forEachOverlappingPair(TypeTag::Mask typeA, TypeTag::Mask typeB,
+                                   F f)
+{
+    refreshSweep();
+
+    // f may list entities, growing sweep_.entities but not the other arrays
+    auto const& entities = sweep_.entities;
+    const std::size_t count = sweep_.minX.size();
+    const double* minX = sweep_.minX.data();
+    const double* maxX = sweep_.maxX.data();
+    const double* minY = sweep_.minY.data();
+    const double* maxY = sweep_.maxY.data();
+    const TypeTag::Mask* types = sweep_.types.data();
+    const TypeTag::Mask either = typeA | typeB;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (not (types[i] & either)) {
+            continue;
+        }
+
+        const double right = maxX[i];
+        const double top = minY[i];
+        const double bottom = maxY[i];
+        const bool isA = (types[i] & typeA) != 0;
+        const bool isB = (types[i] & typeB) != 0;
+
+        for (std::size_t j = i + 1; j < count and minX[j] <= right; ++j) {
+            // Few candidates match, so test everything at once and branch
+            // only on the result
+            const bool forward = isA & ((types[j] & typeB) != 0);
+            const bool backward = isB & ((types[j] & typeA) != 0);
+            if (not ((minY[j] <= bottom) & (maxY[j] >= top) &
+                     (forward | backward))) {
+                continue;
+            }
+
+            Entity* first = entities[i];
+            Entity* second = entities[j];
+            if (not first or not second) {
+                continue;
+            }
+
+            if (forward) {
+                f(*first, *second);
+            } else {
+                f(*second, *first);
+            }
+        }
+    }
 }
 }
 
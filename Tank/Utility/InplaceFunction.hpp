@@ -0,0 +1,220 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_INPLACEFUNCTION_HPP
+#define TANK_INPLACEFUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tank
+{
+
+template <typename Signature, std::size_t Capacity = 48>
+class InplaceFunction;
+
+/*!
+ * \brief A function wrapper like std::function, which keeps small function
+ * objects inside itself instead of allocating them
+ *
+ * Function objects up to Capacity bytes that don't throw when moved are
+ * stored in place; anything else is stored on the heap, as std::function
+ * would. Calling an empty InplaceFunction throws std::bad_function_call.
+ *
+ * \tparam Capacity Bytes of storage for the function object
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+    struct Ops
+    {
+        R (*invoke)(void* f, Args... args);
+        void (*copy)(void* to, void const* from);
+        // Leaves from empty
+        void (*move)(void* to, void* from);
+        void (*destroy)(void* f);
+    };
+
+    using Storage = typename std::aligned_storage<Capacity,
+                                                  alignof(void*)>::type;
+
+    template <typename F>
+    struct Inplace
+    {
+        static R invoke(void* f, Args... args)
+        {
+            return (*static_cast<F*>(f))(std::forward<Args>(args)...);
+        }
+        static void copy(void* to, void const* from)
+        {
+            new (to) F(*static_cast<F const*>(from));
+        }
+        static void move(void* to, void* from)
+        {
+            new (to) F(std::move(*static_cast<F*>(from)));
+            static_cast<F*>(from)->~F();
+        }
+        static void destroy(void* f)
+        {
+            static_cast<F*>(f)->~F();
+        }
+        static Ops const* ops()
+        {
+            static const Ops table = {invoke, copy, move, destroy};
+            return &table;
+        }
+    };
+
+    template <typename F>
+    struct Boxed
+    {
+        static F* get(void const* f)
+        {
+            return *static_cast<F* const*>(f);
+        }
+        static R invoke(void* f, Args... args)
+        {
+            return (*get(f))(std::forward<Args>(args)...);
+        }
+        static void copy(void* to, void const* from)
+        {
+            new (to) F*(new F(*get(from)));
+        }
+        static void move(void* to, void* from)
+        {
+            new (to) F*(get(from));
+        }
+        static void destroy(void* f)
+        {
+            delete get(f);
+        }
+        static Ops const* ops()
+        {
+            static const Ops table = {invoke, copy, move, destroy};
+            return &table;
+        }
+    };
+
+    template <typename F>
+    using Store = typename std::conditional<
+            sizeof(F) <= Capacity and alignof(F) <= alignof(Storage) and
+                    std::is_nothrow_move_constructible<F>::value,
+            Inplace<F>, Boxed<F>>::type;
+
+    Storage storage_;
+    Ops const* ops_ {nullptr};
+
+public:
+    InplaceFunction() = default;
+
+    InplaceFunction(std::nullptr_t)
+    {
+    }
+
+    template <typename F, typename D = typename std::decay<F>::type,
+              typename = typename std::enable_if<
+                      not std::is_same<D, InplaceFunction>::value>::type,
+              typename = decltype(
+                      std::declval<D&>()(std::declval<Args>()...))>
+    InplaceFunction(F&& f)
+    {
+        construct<D>(std::forward<F>(f),
+                     std::is_same<Store<D>, Inplace<D>>{});
+        ops_ = Store<D>::ops();
+    }
+
+    InplaceFunction(InplaceFunction const& other) : ops_(other.ops_)
+    {
+        if (ops_) {
+            ops_->copy(&storage_, &other.storage_);
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept : ops_(other.ops_)
+    {
+        if (ops_) {
+            ops_->move(&storage_, &other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    InplaceFunction& operator=(InplaceFunction const& other)
+    {
+        if (this != &other) {
+            InplaceFunction copy{other};
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(&storage_, &other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    R operator()(Args... args) const
+    {
+        if (not ops_) {
+            throw std::bad_function_call();
+        }
+        // Like std::function, calls the function object as non-const
+        return ops_->invoke(const_cast<Storage*>(&storage_),
+                            std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const
+    {
+        return ops_ != nullptr;
+    }
+
+    /*! \brief Returns whether a function object of type F is stored in place */
+    template <typename F>
+    static constexpr bool isInplace()
+    {
+        return std::is_same<Store<typename std::decay<F>::type>,
+                            Inplace<typename std::decay<F>::type>>::value;
+    }
+
+private:
+    template <typename D, typename F>
+    void construct(F&& f, std::true_type /* in place */)
+    {
+        new (&storage_) D(std::forward<F>(f));
+    }
+
+    template <typename D, typename F>
+    void construct(F&& f, std::false_type /* in place */)
+    {
+        new (&storage_) D*(new D(std::forward<F>(f)));
+    }
+
+    void reset()
+    {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+};
+
+} // tank
+
+#endif /* TANK_INPLACEFUNCTION_HPP */
@@ -0,0 +1,160 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace tank
+{
+
+namespace
+{
+void writeEscaped(std::ostream& out, char const* str)
+{
+    for (; *str; ++str) {
+        if (*str == '"' or *str == '\\') {
+            out << '\\';
+        }
+        out << *str;
+    }
+}
+}
+
+Profiler::Clock::time_point Profiler::epoch_ = Profiler::Clock::now();
+std::int64_t Profiler::lastFrame_ = -1;
+std::array<double, Profiler::frameWindow> Profiler::frameTimes_;
+std::size_t Profiler::frameCount_ = 0;
+std::mutex Profiler::buffersMutex_;
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::buffers_;
+thread_local Profiler::ThreadBuffer* Profiler::currentBuffer_ = nullptr;
+
+Profiler::ThreadBuffer& Profiler::threadBuffer()
+{
+    if (not currentBuffer_) {
+        std::unique_ptr<ThreadBuffer> buffer {new ThreadBuffer};
+
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffer->id = buffers_.size() + 1;
+        currentBuffer_ = buffer.get();
+        buffers_.push_back(std::move(buffer));
+    }
+    return *currentBuffer_;
+}
+
+void Profiler::record(char const* name, std::int64_t start, std::int64_t end)
+{
+    ThreadBuffer& buffer = threadBuffer();
+
+    // Only this thread writes to the buffer, so the head needs no
+    // read-modify-write; the release store publishes the event to readers
+    const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    Event& event = buffer.events[head % bufferSize];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame()
+{
+    const std::int64_t time = now();
+    if (lastFrame_ >= 0) {
+        frameTimes_[frameCount_ % frameWindow] = (time - lastFrame_) / 1.0e6;
+        ++frameCount_;
+    }
+    lastFrame_ = time;
+}
+
+Profiler::FrameStats Profiler::frameStats()
+{
+    const std::size_t count = std::min(frameCount_, frameWindow);
+    FrameStats stats {count, 0, 0, 0, 0, 0};
+    if (count == 0) {
+        return stats;
+    }
+
+    std::vector<double> times(frameTimes_.begin(), frameTimes_.begin() + count);
+
+    auto percentile = [&times](double p) {
+        const std::size_t rank = static_cast<std::size_t>(p * (times.size() - 1));
+        std::nth_element(times.begin(), times.begin() + rank, times.end());
+        return times[rank];
+    };
+
+    for (double time : times) {
+        stats.mean += time;
+        stats.max = std::max(stats.max, time);
+    }
+    stats.mean /= count;
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+
+    return stats;
+}
+
+bool Profiler::writeChromeTrace(std::string const& file)
+{
+    std::ofstream out(file);
+    if (not out) {
+        return false;
+    }
+
+    // Microseconds, to the nanosecond
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    for (auto const& buffer : buffers_) {
+        const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const std::uint64_t oldest = head > bufferSize ? head - bufferSize : 0;
+
+        struct Copy
+        {
+            char const* name;
+            std::int64_t start;
+            std::int64_t end;
+        };
+        std::vector<Copy> events;
+        events.reserve(head - oldest);
+        for (std::uint64_t i = oldest; i < head; ++i) {
+            Event const& event = buffer->events[i % bufferSize];
+            events.push_back({event.name.load(std::memory_order_relaxed),
+                              event.start.load(std::memory_order_relaxed),
+                              event.end.load(std::memory_order_relaxed)});
+        }
+
+        // The owning thread may have lapped us while we copied; anything it
+        // could have overwritten is dropped rather than reported torn. That
+        // includes the slot it may be writing now, event `after`, which holds
+        // event `after - bufferSize`.
+        const std::uint64_t after = buffer->head.load(std::memory_order_acquire);
+        const std::uint64_t safe =
+                after >= bufferSize ? after - bufferSize + 1 : 0;
+        const std::size_t skip = safe > oldest
+                ? std::min<std::uint64_t>(safe - oldest, events.size()) : 0;
+
+        for (std::size_t i = skip; i < events.size(); ++i) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"";
+            writeEscaped(out, events[i].name);
+            out << "\",\"cat\":\"tank\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer->id
+                << ",\"ts\":" << events[i].start / 1000.0
+                << ",\"dur\":" << (events[i].end - events[i].start) / 1000.0
+                << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // tank
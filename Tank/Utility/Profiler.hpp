@@ -0,0 +1,193 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_PROFILER_HPP
+#define TANK_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+ * \def TANK_PROFILE_ZONE(name)
+ * \brief Times the rest of the enclosing scope under `name`
+ *
+ * `name` must be a string literal (or otherwise outlive the profiler). Does
+ * nothing unless `TANK_PROFILE` is defined (see the `PROFILE` CMake option).
+ */
+/*!
+ * \def TANK_PROFILE_FRAME()
+ * \brief Marks the end of a frame. Game::run() does this for you.
+ */
+#ifdef TANK_PROFILE
+#define TANK_PROFILE_CONCAT_(a, b) a##b
+#define TANK_PROFILE_CONCAT(a, b) TANK_PROFILE_CONCAT_(a, b)
+#define TANK_PROFILE_ZONE(name)                                               \
+    ::tank::Profiler::Zone TANK_PROFILE_CONCAT(tankProfileZone, __LINE__)     \
+    {                                                                         \
+        name                                                                  \
+    }
+#define TANK_PROFILE_FRAME() ::tank::Profiler::endFrame()
+#else
+#define TANK_PROFILE_ZONE(name) (void)0
+#define TANK_PROFILE_FRAME() (void)0
+#endif
+
+namespace tank
+{
+
+/*!
+ * \brief Static class recording where the time in each frame goes.
+ *
+ * Code is timed in *zones*, which are usually marked with the
+ * TANK_PROFILE_ZONE() macro:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     void MyWorld::update()
+ *     {
+ *         TANK_PROFILE_ZONE("MyWorld::update");
+ *         tank::World::update();
+ *         // ...
+ *     }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The macros only do something if `TANK_PROFILE` is defined, so they can be
+ * left in release code for free. The engine's own main loop phases are marked
+ * this way.
+ *
+ * Each thread writes its zones to its own fixed-size ring buffer without
+ * locking, so the most recent events are kept and older ones are overwritten.
+ * Frame times are kept separately, for the last Profiler::frameWindow frames.
+ *
+ * writeChromeTrace() saves the recorded zones in the Trace Event format, which
+ * can be opened with `about:tracing` in Chrome or https://ui.perfetto.dev.
+ */
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /*! \brief Number of zones kept per thread */
+    static constexpr std::size_t bufferSize = 1 << 16;
+
+    /*! \brief Number of frames kept for frame statistics */
+    static constexpr std::size_t frameWindow = 512;
+
+    /*!
+     * \brief Times its own lifetime
+     */
+    class Zone
+    {
+        char const* name_;
+        std::int64_t start_;
+
+    public:
+        explicit Zone(char const* name) : name_(name), start_(now())
+        {
+        }
+        Zone(Zone const&) = delete;
+        Zone& operator=(Zone const&) = delete;
+        ~Zone()
+        {
+            record(name_, start_, now());
+        }
+    };
+
+    /*!
+     * \brief Frame time statistics, in milliseconds
+     */
+    struct FrameStats
+    {
+        std::size_t frames;
+        double mean;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+private:
+    struct Event
+    {
+        std::atomic<char const*> name;
+        std::atomic<std::int64_t> start;
+        std::atomic<std::int64_t> end;
+    };
+
+    struct ThreadBuffer
+    {
+        std::array<Event, bufferSize> events;
+        std::atomic<std::uint64_t> head{0};
+        unsigned int id;
+    };
+
+    static Clock::time_point epoch_;
+    static std::int64_t lastFrame_;
+    static std::array<double, frameWindow> frameTimes_;
+    static std::size_t frameCount_;
+
+    // Buffers are kept until exit, so zones recorded by threads that have
+    // since finished still make it into the trace
+    static std::mutex buffersMutex_;
+    static std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+    static thread_local ThreadBuffer* currentBuffer_;
+
+public:
+    Profiler() = delete;
+    ~Profiler() = delete;
+
+    /*!
+     * \brief Returns the time since the profiler started, in nanoseconds
+     */
+    static std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - epoch_).count();
+    }
+
+    /*!
+     * \brief Records a zone on the calling thread
+     *
+     * \param name The zone's name, which must outlive the profiler
+     * \param start Value of now() when the zone began
+     * \param end Value of now() when the zone ended
+     */
+    static void record(char const* name, std::int64_t start, std::int64_t end);
+
+    /*!
+     * \brief Marks the end of a frame, adding its length to the frame
+     * statistics
+     *
+     * Should be called from one thread only.
+     */
+    static void endFrame();
+
+    /*!
+     * \brief Returns statistics over the last Profiler::frameWindow frames
+     */
+    static FrameStats frameStats();
+
+    /*!
+     * \brief Writes the recorded zones of every thread as Chrome trace JSON
+     *
+     * Can be called while other threads are still recording.
+     *
+     * \param file The file to write to, *e.g.* `"trace.json"`
+     * \return `true` on success.
+     */
+    static bool writeChromeTrace(std::string const& file);
+
+private:
+    static ThreadBuffer& threadBuffer();
+};
+
+} // tank
+
+#endif /* TANK_PROFILER_HPP */
@@ -0,0 +1,92 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_RINGBUFFER_HPP
+#define TANK_RINGBUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace tank
+{
+
+/*!
+ * \brief A fixed-size queue passing values from one thread to another
+ * without locking
+ *
+ * Exactly one thread may push() and exactly one thread may pop(). Neither
+ * ever blocks: push() fails when the buffer is full, and pop() when it is
+ * empty.
+ *
+ * \tparam Capacity The number of values the buffer holds, a power of two
+ */
+template <typename T, std::size_t Capacity>
+class RingBuffer
+{
+    static_assert(Capacity > 0 and (Capacity & (Capacity - 1)) == 0,
+                  "RingBuffer capacity must be a power of two");
+
+    std::array<T, Capacity> values_;
+    // On separate cache lines, as each is written by a different thread.
+    // They only ever grow, and wrap around on overflow.
+    alignas(64) std::atomic<std::size_t> head_ {0}; // Next to pop
+    alignas(64) std::atomic<std::size_t> tail_ {0}; // Next to push
+
+public:
+    RingBuffer() = default;
+    RingBuffer(RingBuffer const&) = delete;
+    RingBuffer& operator=(RingBuffer const&) = delete;
+
+    /*!
+     * \brief Adds a value, from the producing thread
+     *
+     * \return `false` if the buffer is full
+     */
+    bool push(T const& value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        values_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Removes the oldest value, from the consuming thread
+     *
+     * \return `false` if the buffer is empty
+     */
+    bool pop(T& value)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = values_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*! \brief Returns whether the buffer is empty, from either thread */
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity()
+    {
+        return Capacity;
+    }
+};
+
+} // tank
+
+#endif /* TANK_RINGBUFFER_HPP */
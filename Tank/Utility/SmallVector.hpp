@@ -0,0 +1,124 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_SMALLVECTOR_HPP
+#define TANK_SMALLVECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace tank
+{
+
+/*!
+ * \brief A growable array which keeps its first Capacity elements inside
+ * itself instead of allocating them
+ *
+ * Only as much of std::vector as Tank needs, for trivially copyable types.
+ * Once it outgrows its own storage it moves to the heap, as std::vector
+ * would, and stays there.
+ *
+ * \tparam Capacity Elements stored in place
+ */
+template <typename T, std::size_t Capacity>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector only holds trivially copyable types");
+    static_assert(Capacity > 0, "SmallVector needs room for an element");
+
+    T inplace_[Capacity];
+    T* data_ {inplace_};
+    std::size_t size_ {0};
+    std::size_t capacity_ {Capacity};
+
+public:
+    SmallVector() = default;
+    SmallVector(SmallVector const&) = delete;
+    SmallVector& operator=(SmallVector const&) = delete;
+
+    ~SmallVector()
+    {
+        if (data_ != inplace_) {
+            delete[] data_;
+        }
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T& operator[](std::size_t i)
+    {
+        return data_[i];
+    }
+
+    T const& operator[](std::size_t i) const
+    {
+        return data_[i];
+    }
+
+    T* begin()
+    {
+        return data_;
+    }
+
+    T* end()
+    {
+        return data_ + size_;
+    }
+
+    T const* begin() const
+    {
+        return data_;
+    }
+
+    T const* end() const
+    {
+        return data_ + size_;
+    }
+
+    void push_back(T value)
+    {
+        if (size_ == capacity_) {
+            grow();
+        }
+        data_[size_++] = value;
+    }
+
+    /*!
+     * \brief Removes every element, keeping the storage
+     */
+    void clear()
+    {
+        size_ = 0;
+    }
+
+private:
+    void grow()
+    {
+        // Never less than Capacity, which some compilers can't see for
+        // themselves
+        const std::size_t capacity = std::max(capacity_, Capacity) * 2;
+        T* data = new T[capacity];
+        std::copy(data_, data_ + size_, data);
+        if (data_ != inplace_) {
+            delete[] data_;
+        }
+        data_ = data;
+        capacity_ = capacity;
+    }
+};
+
+} // tank
+
+#endif /* TANK_SMALLVECTOR_HPP */
@@ -0,0 +1,363 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_SPATIALHASH_HPP
+#define TANK_SPATIALHASH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "Rect.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief A uniform grid of square cells, each listing the items whose bounds
+ * overlap it.
+ *
+ * Only cells with something in them are stored, so the grid has no edges.
+ * Items that would cover more than a set number of cells (or whose bounds
+ * aren't finite) are kept in a separate list instead, which every query
+ * visits.
+ *
+ * Each item has a SpatialHash::Cells, kept by the caller, recording where it
+ * was stored. update() compares the item's new cells against it, so an item
+ * that moves within its cells costs nothing.
+ *
+ * Bounds are closed: two items whose edges touch share a cell.
+ *
+ * \tparam T The type of item stored (as a pointer)
+ * \see World::setCellSize()
+ */
+template <typename T>
+class SpatialHash
+{
+public:
+    /*!
+     * \brief The range of cells an item is stored in
+     */
+    struct Cells
+    {
+        int left {0};
+        int top {0};
+        int right {-1};
+        int bottom {-1};
+        bool stored {false};
+        bool oversized {false};
+    };
+
+private:
+    double cellSize_;
+    std::size_t maxCells_;
+    std::unordered_map<std::uint64_t, std::vector<T*>> cells_;
+    std::vector<T*> oversized_;
+    std::size_t emptyCells_ {0};
+    std::size_t size_ {0};
+
+public:
+    /*!
+     * \brief Creates an empty hash
+     *
+     * \param cellSize The width and height of a cell
+     * \param maxCells The most cells an item can cover before it is put in
+     *        the oversized list
+     */
+    explicit SpatialHash(double cellSize = 64, std::size_t maxCells = 64);
+
+    double getCellSize() const
+    {
+        return cellSize_;
+    }
+
+    /*!
+     * \brief Changes the cell size, removing every item
+     *
+     * Items must be inserted again, with fresh Cells.
+     */
+    void setCellSize(double cellSize);
+
+    /*!
+     * \brief Returns the number of items stored
+     */
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /*!
+     * \brief Adds an item to the cells its bounds cover
+     *
+     * \param item The item to add
+     * \param bounds The item's bounds
+     * \param cells Set to the cells the item was stored in
+     */
+    void insert(T* item, Rectd const& bounds, Cells& cells);
+
+    /*!
+     * \brief Moves an item to the cells its new bounds cover, if they differ
+     *
+     * \param item The item to move, which must have been inserted
+     * \param bounds The item's new bounds
+     * \param cells The cells the item is stored in, which are updated
+     */
+    void update(T* item, Rectd const& bounds, Cells& cells);
+
+    /*!
+     * \brief Removes an item
+     *
+     * \param item The item to remove
+     * \param cells The cells the item is stored in, which are reset
+     */
+    void remove(T* item, Cells& cells);
+
+    /*!
+     * \brief Calls f for every item in a cell that bounds overlap
+     *
+     * Items covering several of those cells are visited more than once, and
+     * items are visited in no particular order. Any item whose bounds overlap
+     * bounds is visited, but so may be items that don't.
+     *
+     * \param bounds The area to look in
+     * \param f A function taking a T*
+     */
+    template <typename F>
+    void query(Rectd const& bounds, F f) const;
+
+    /*!
+     * \brief Removes every item
+     */
+    void clear();
+
+private:
+    bool cellsFor(Rectd const& bounds, Cells& cells,
+                  std::size_t maxCells) const;
+    void add(T* item, Cells const& cells);
+    void erase(T* item, Cells const& cells);
+    void removeFrom(std::vector<T*>& list, T* item);
+
+    static std::uint64_t key(int x, int y)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x))
+                << 32) | static_cast<std::uint32_t>(y);
+    }
+};
+
+template <typename T>
+SpatialHash<T>::SpatialHash(double cellSize, std::size_t maxCells)
+        : cellSize_(cellSize), maxCells_(maxCells)
+{
+    if (not (cellSize > 0)) {
+        throw std::invalid_argument("Cell size must be positive");
+    }
+}
+
+template <typename T>
+void SpatialHash<T>::setCellSize(double cellSize)
+{
+    if (not (cellSize > 0)) {
+        throw std::invalid_argument("Cell size must be positive");
+    }
+    clear();
+    cellSize_ = cellSize;
+}
+
+template <typename T>
+void SpatialHash<T>::insert(T* item, Rectd const& bounds, Cells& cells)
+{
+    cells.oversized = not cellsFor(bounds, cells, maxCells_);
+    add(item, cells);
+    cells.stored = true;
+    ++size_;
+}
+
+template <typename T>
+void SpatialHash<T>::update(T* item, Rectd const& bounds, Cells& cells)
+{
+    Cells next;
+    next.oversized = not cellsFor(bounds, next, maxCells_);
+    next.stored = true;
+
+    if (next.oversized == cells.oversized and
+        (cells.oversized or
+         (next.left == cells.left and next.top == cells.top and
+          next.right == cells.right and next.bottom == cells.bottom))) {
+        return;
+    }
+
+    erase(item, cells);
+    add(item, next);
+    cells = next;
+}
+
+template <typename T>
+void SpatialHash<T>::remove(T* item, Cells& cells)
+{
+    if (cells.stored) {
+        erase(item, cells);
+        --size_;
+    }
+    cells = Cells{};
+}
+
+template <typename T>
+template <typename F>
+void SpatialHash<T>::query(Rectd const& bounds, F f) const
+{
+    Cells range;
+    const bool bounded = cellsFor(bounds, range, SIZE_MAX);
+    const std::size_t count =
+            bounded ? (static_cast<std::size_t>(range.right) - range.left + 1) *
+                              (static_cast<std::size_t>(range.bottom) -
+                               range.top + 1)
+                    : 0;
+
+    if (not bounded or count > cells_.size()) {
+        // Cheaper to look at every stored cell than every cell in range
+        for (auto const& cell : cells_) {
+            const int x = static_cast<std::int32_t>(cell.first >> 32);
+            const int y = static_cast<std::int32_t>(cell.first & 0xffffffff);
+            if (not bounded or (x >= range.left and x <= range.right and
+                                y >= range.top and y <= range.bottom)) {
+                for (T* item : cell.second) {
+                    f(item);
+                }
+            }
+        }
+    } else {
+        for (int y = range.top; y <= range.bottom; ++y) {
+            for (int x = range.left; x <= range.right; ++x) {
+                auto iter = cells_.find(key(x, y));
+                if (iter != cells_.end()) {
+                    for (T* item : iter->second) {
+                        f(item);
+                    }
+                }
+            }
+        }
+    }
+
+    for (T* item : oversized_) {
+        f(item);
+    }
+}
+
+template <typename T>
+void SpatialHash<T>::clear()
+{
+    cells_.clear();
+    oversized_.clear();
+    emptyCells_ = 0;
+    size_ = 0;
+}
+
+template <typename T>
+bool SpatialHash<T>::cellsFor(Rectd const& bounds, Cells& cells,
+                              std::size_t maxCells) const
+{
+    if (not (std::isfinite(bounds.x) and std::isfinite(bounds.y) and
+             std::isfinite(bounds.w) and std::isfinite(bounds.h))) {
+        return false;
+    }
+
+    const double left = std::floor(std::min(bounds.x, bounds.x + bounds.w) /
+                                   cellSize_);
+    const double right = std::floor(std::max(bounds.x, bounds.x + bounds.w) /
+                                    cellSize_);
+    const double top = std::floor(std::min(bounds.y, bounds.y + bounds.h) /
+                                  cellSize_);
+    const double bottom = std::floor(std::max(bounds.y, bounds.y + bounds.h) /
+                                     cellSize_);
+
+    const double limit = 1 << 30;
+    if (not (left >= -limit and right <= limit and top >= -limit and
+             bottom <= limit)) {
+        return false;
+    }
+    if ((right - left + 1) * (bottom - top + 1) > maxCells) {
+        return false;
+    }
+
+    cells.left = static_cast<int>(left);
+    cells.right = static_cast<int>(right);
+    cells.top = static_cast<int>(top);
+    cells.bottom = static_cast<int>(bottom);
+    return true;
+}
+
+template <typename T>
+void SpatialHash<T>::add(T* item, Cells const& cells)
+{
+    if (cells.oversized) {
+        oversized_.push_back(item);
+        return;
+    }
+
+    for (int y = cells.top; y <= cells.bottom; ++y) {
+        for (int x = cells.left; x <= cells.right; ++x) {
+            auto& list = cells_[key(x, y)];
+            if (list.empty() and list.capacity() > 0 and emptyCells_ > 0) {
+                --emptyCells_;
+            }
+            list.push_back(item);
+        }
+    }
+}
+
+template <typename T>
+void SpatialHash<T>::erase(T* item, Cells const& cells)
+{
+    if (not cells.stored) {
+        return;
+    }
+
+    if (cells.oversized) {
+        removeFrom(oversized_, item);
+        return;
+    }
+
+    for (int y = cells.top; y <= cells.bottom; ++y) {
+        for (int x = cells.left; x <= cells.right; ++x) {
+            auto iter = cells_.find(key(x, y));
+            if (iter == cells_.end()) {
+                continue;
+            }
+            removeFrom(iter->second, item);
+            if (iter->second.empty()) {
+                ++emptyCells_;
+            }
+        }
+    }
+
+    // Empty cells are kept, so items moving back and forth don't reallocate,
+    // until there are far more of them than items
+    if (emptyCells_ > 4 * size_ + 4096) {
+        for (auto iter = cells_.begin(); iter != cells_.end();) {
+            if (iter->second.empty()) {
+                iter = cells_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        emptyCells_ = 0;
+    }
+}
+
+template <typename T>
+void SpatialHash<T>::removeFrom(std::vector<T*>& list, T* item)
+{
+    auto iter = std::find(list.begin(), list.end(), item);
+    if (iter != list.end()) {
+        *iter = list.back();
+        list.pop_back();
+    }
+}
+
+} // tank
+
+#endif /* TANK_SPATIALHASH_HPP */
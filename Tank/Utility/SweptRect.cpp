@@ -0,0 +1,88 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "SweptRect.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace tank
+{
+
+namespace
+{
+/*
+ * Finds the times the moving interval [aMin, aMax] starts and stops
+ * overlapping [bMin, bMax] on one axis
+ */
+bool axisTimes(double aMin, double aMax, double bMin, double bMax, double d,
+               double& entry, double& exit)
+{
+    if (d > 0) {
+        entry = (bMin - aMax) / d;
+        exit = (bMax - aMin) / d;
+    } else if (d < 0) {
+        entry = (bMax - aMin) / d;
+        exit = (bMin - aMax) / d;
+    } else {
+        // Not moving on this axis: they must already overlap on it, by more
+        // than touching
+        if (aMax <= bMin + sweepSkin or aMin >= bMax - sweepSkin) {
+            return false;
+        }
+        entry = -std::numeric_limits<double>::infinity();
+        exit = std::numeric_limits<double>::infinity();
+    }
+    return true;
+}
+}
+
+bool sweepRect(Rectd const& moving, Vectord const& disp, Rectd const& target,
+               double& time, Vectord& normal)
+{
+    if (disp.x == 0 and disp.y == 0) {
+        return false;
+    }
+
+    const double aLeft = std::min(moving.x, moving.x + moving.w);
+    const double aRight = std::max(moving.x, moving.x + moving.w);
+    const double aTop = std::min(moving.y, moving.y + moving.h);
+    const double aBottom = std::max(moving.y, moving.y + moving.h);
+    const double bLeft = std::min(target.x, target.x + target.w);
+    const double bRight = std::max(target.x, target.x + target.w);
+    const double bTop = std::min(target.y, target.y + target.h);
+    const double bBottom = std::max(target.y, target.y + target.h);
+
+    double entryX, exitX, entryY, exitY;
+    if (not axisTimes(aLeft, aRight, bLeft, bRight, disp.x, entryX, exitX) or
+        not axisTimes(aTop, aBottom, bTop, bBottom, disp.y, entryY, exitY)) {
+        return false;
+    }
+
+    const bool alongX = entryX > entryY;
+    const double entry = alongX ? entryX : entryY;
+    const double exit = std::min(exitX, exitY);
+    if (not (entry < exit) or entry > 1 or exit <= 0) {
+        return false;
+    }
+
+    if (entry < 0) {
+        // Already overlapping: only count it if by no more than the skin
+        const double depth = alongX ? -entry * disp.x : -entry * disp.y;
+        if (depth > sweepSkin or depth < -sweepSkin) {
+            return false;
+        }
+    }
+
+    time = std::max(entry, 0.0);
+    if (alongX) {
+        normal = {disp.x > 0 ? -1.0 : 1.0, 0.0};
+    } else {
+        normal = {0.0, disp.y > 0 ? -1.0 : 1.0};
+    }
+    return true;
+}
+
+} // tank
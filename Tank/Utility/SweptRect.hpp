@@ -0,0 +1,46 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_SWEPTRECT_HPP
+#define TANK_SWEPTRECT_HPP
+
+#include "Rect.hpp"
+#include "Vector.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief How far two rectangles can overlap and still count as touching
+ *
+ * Positions are floats, so a rectangle moved to exactly touch another can
+ * end up overlapping it by a rounding error. Overlaps this small are treated
+ * as touching, so the rectangle is still blocked on its next move.
+ */
+constexpr double sweepSkin = 0.01;
+
+/*!
+ * \brief Finds when a moving rectangle first hits a still one
+ *
+ * Rectangles that only touch (or overlap by no more than sweepSkin) are hit
+ * at time 0 if moving towards each other, and not hit if sliding along each
+ * other or moving apart. Rectangles that already overlap by more than that
+ * are never hit, so that whatever has got stuck can move out.
+ *
+ * \param moving The moving rectangle, at the start of its move
+ * \param disp How far the rectangle moves
+ * \param target The still rectangle
+ * \param time Set to the fraction of disp, from 0 to 1, moved before the
+ *        rectangles touch
+ * \param normal Set to the unit vector pointing out of the side of target
+ *        that was hit
+ * \return `true` if the rectangles touch during the move
+ */
+bool sweepRect(Rectd const& moving, Vectord const& disp, Rectd const& target,
+               double& time, Vectord& normal);
+
+} // tank
+
+#endif /* TANK_SWEPTRECT_HPP */
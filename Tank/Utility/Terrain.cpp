@@ -0,0 +1,164 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "Terrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "SweptRect.hpp"
+
+namespace tank
+{
+
+Terrain::Terrain(CollisionGrid grid, Vectord tileSize, Vectord offset)
+        : grid_(std::move(grid)), tileSize_(tileSize), offset_(offset)
+{
+    if (not (tileSize.x > 0 and tileSize.y > 0)) {
+        throw std::invalid_argument("Tile size must be positive");
+    }
+}
+
+bool Terrain::overlaps(Rectd const& box) const
+{
+    const double left = std::min(box.x, box.x + box.w);
+    const double right = std::max(box.x, box.x + box.w);
+    const double top = std::min(box.y, box.y + box.h);
+    const double bottom = std::max(box.y, box.y + box.h);
+
+    if (not (std::isfinite(left) and std::isfinite(right) and
+             std::isfinite(top) and std::isfinite(bottom))) {
+        return false;
+    }
+
+    const long width = grid_.getWidth();
+    const long height = grid_.getHeight();
+    const long firstX = std::max(
+            0.0, std::floor((left + sweepSkin - offset_.x) / tileSize_.x));
+    const long lastX = std::min<double>(
+            width - 1,
+            std::floor((right - sweepSkin - offset_.x) / tileSize_.x));
+    const long firstY = std::max(
+            0.0, std::floor((top + sweepSkin - offset_.y) / tileSize_.y));
+    const long lastY = std::min<double>(
+            height - 1,
+            std::floor((bottom - sweepSkin - offset_.y) / tileSize_.y));
+
+    for (long y = firstY; y <= lastY; ++y) {
+        for (long x = firstX; x <= lastX; ++x) {
+            if (isSolid(x, y)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+TerrainMove Terrain::move(Rectd const& box, Vectord disp) const
+{
+    TerrainMove result;
+    if (not (std::isfinite(box.x) and std::isfinite(box.y) and
+             std::isfinite(box.w) and std::isfinite(box.h) and
+             std::isfinite(disp.x) and std::isfinite(disp.y))) {
+        result.moved = disp;
+        return result;
+    }
+
+    double left = std::min(box.x, box.x + box.w);
+    double right = std::max(box.x, box.x + box.w);
+    double top = std::min(box.y, box.y + box.h);
+    double bottom = std::max(box.y, box.y + box.h);
+
+    if (disp.x != 0) {
+        const double moved = disp.x > 0
+                ? moveAxis(right, disp.x, top, bottom, true)
+                : moveAxis(left, disp.x, top, bottom, true);
+        result.moved.x = moved;
+        if (moved != disp.x) {
+            result.wallRight = disp.x > 0;
+            result.wallLeft = disp.x < 0;
+        }
+        left += moved;
+        right += moved;
+    }
+
+    if (disp.y != 0) {
+        const double moved = disp.y > 0
+                ? moveAxis(bottom, disp.y, left, right, false)
+                : moveAxis(top, disp.y, left, right, false);
+        result.moved.y = moved;
+        if (moved != disp.y) {
+            result.grounded = disp.y > 0;
+            result.ceiling = disp.y < 0;
+        }
+    }
+
+    result.remaining = {disp.x - result.moved.x, disp.y - result.moved.y};
+    return result;
+}
+
+/*
+ * Moves the edge lead by disp along one axis, through the band of tiles
+ * between first and last on the other axis, and returns how far it got
+ */
+double Terrain::moveAxis(double lead, double disp, double first, double last,
+                         bool horizontal) const
+{
+    const double size = horizontal ? tileSize_.x : tileSize_.y;
+    const double origin = horizontal ? offset_.x : offset_.y;
+    const double crossSize = horizontal ? tileSize_.y : tileSize_.x;
+    const double crossOrigin = horizontal ? offset_.y : offset_.x;
+    const long length = horizontal ? grid_.getWidth() : grid_.getHeight();
+    const long crossLength = horizontal ? grid_.getHeight() : grid_.getWidth();
+
+    // Touching a tile's side doesn't put a box in its row
+    const long bandFirst = std::max(
+            0.0, std::floor((first + sweepSkin - crossOrigin) / crossSize));
+    const long bandLast = std::min<double>(
+            crossLength - 1,
+            std::floor((last - sweepSkin - crossOrigin) / crossSize));
+    if (bandFirst > bandLast or length == 0) {
+        return disp;
+    }
+
+    auto blocked = [&](long line) {
+        for (long cross = bandFirst; cross <= bandLast; ++cross) {
+            if (horizontal ? isSolid(line, cross) : isSolid(cross, line)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const double step = disp > 0 ? 1 : -1;
+    const double skin = step * sweepSkin;
+
+    // Lines of tiles past the one the leading edge is in, up to the one it
+    // ends in, clamped to the grid
+    const double from = std::floor((lead - skin - origin) / size) + step;
+    const double to = std::floor((lead + disp - skin - origin) / size);
+    long line, end;
+    if (disp > 0) {
+        line = std::max(from, 0.0);
+        end = std::min<double>(to, length - 1);
+    } else {
+        line = std::min<double>(from, length - 1);
+        end = std::max(to, 0.0);
+    }
+
+    for (; disp > 0 ? line <= end : line >= end; line += long(step)) {
+        if (blocked(line)) {
+            const double wall = origin + (disp > 0 ? line : line + 1) * size;
+            const double moved = wall - lead;
+            // Never backwards, in case the box was already within the skin
+            return disp > 0 ? std::max(0.0, std::min(disp, moved))
+                            : std::min(0.0, std::max(disp, moved));
+        }
+    }
+
+    return disp;
+}
+
+} // tank
@@ -0,0 +1,135 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_TERRAIN_HPP
+#define TANK_TERRAIN_HPP
+
+#include "CollisionGrid.hpp"
+#include "Rect.hpp"
+#include "Vector.hpp"
+
+namespace tank
+{
+
+/*!
+ * \brief The outcome of moving a rectangle through Terrain
+ */
+struct TerrainMove
+{
+    /*! \brief How far the rectangle moved */
+    Vectord moved {};
+    /*! \brief The part of the displacement that was blocked */
+    Vectord remaining {};
+    /*! \brief Stopped by the top of a tile while moving down */
+    bool grounded {false};
+    /*! \brief Stopped by the bottom of a tile while moving up */
+    bool ceiling {false};
+    /*! \brief Stopped by the right side of a tile while moving left */
+    bool wallLeft {false};
+    /*! \brief Stopped by the left side of a tile while moving right */
+    bool wallRight {false};
+};
+
+/*!
+ * \brief A CollisionGrid laid out in the world, for entities to move against
+ *
+ * Each cell of the grid is a tile of tileSize, the top left one at offset.
+ * As with Tilemap::getCollisionGrid(), cells that are `false` are solid and
+ * cells that are `true` are open; everything outside the grid is open.
+ *
+ * Moving a rectangle only looks at the tiles it passes over, so a large
+ * level costs no more than a small one, and there's no need for an Entity
+ * per solid tile.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     tank::Terrain terrain{tilemap.getCollisionGrid({1, 2}), {16, 16}};
+ *     // ...
+ *     auto result = player->moveAgainst(terrain, velocity_);
+ *     if (result.grounded) {
+ *         velocity_.y = 0;
+ *     }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * \see Entity.moveAgainst()
+ */
+class Terrain
+{
+    CollisionGrid grid_;
+    Vectord tileSize_;
+    Vectord offset_;
+
+public:
+    /*!
+     * \brief Lays out a grid in the world
+     *
+     * \param grid The grid of open (`true`) and solid (`false`) tiles
+     * \param tileSize The width and height of a tile
+     * \param offset The position of the top left corner of the grid
+     * \throws std::invalid_argument if tileSize isn't positive
+     */
+    Terrain(CollisionGrid grid, Vectord tileSize, Vectord offset = {});
+
+    CollisionGrid const& getGrid() const
+    {
+        return grid_;
+    }
+
+    /*!
+     * \brief Returns the grid, to open or close tiles
+     */
+    CollisionGrid& getGrid()
+    {
+        return grid_;
+    }
+
+    Vectord const& getTileSize() const
+    {
+        return tileSize_;
+    }
+
+    Vectord const& getOffset() const
+    {
+        return offset_;
+    }
+
+    /*!
+     * \brief Returns whether the tile at column x, row y is solid
+     */
+    bool isSolid(long x, long y) const
+    {
+        return x >= 0 and y >= 0 and x < static_cast<long>(grid_.getWidth()) and
+               y < static_cast<long>(grid_.getHeight()) and
+               not grid_[Vectoru(x, y)];
+    }
+
+    /*!
+     * \brief Returns whether a rectangle overlaps any solid tile
+     *
+     * Rectangles that only touch a tile don't overlap it.
+     */
+    bool overlaps(Rectd const& box) const;
+
+    /*!
+     * \brief Moves a rectangle as far as it can go, first horizontally and
+     * then vertically
+     *
+     * Each axis stops at the first solid tile in the way, however far the
+     * rectangle moves, so nothing passes through walls. Tiles the rectangle
+     * already overlaps don't block it, so that it can move out of them.
+     *
+     * \param box The rectangle, at the start of its move
+     * \param disp How far to move it
+     * \return How far it moved, and which sides were blocked
+     */
+    TerrainMove move(Rectd const& box, Vectord disp) const;
+
+private:
+    double moveAxis(double lead, double disp, double first, double last,
+                    bool horizontal) const;
+};
+
+} // tank
+
+#endif /* TANK_TERRAIN_HPP */
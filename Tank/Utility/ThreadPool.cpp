@@ -0,0 +1,217 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace tank
+{
+
+namespace
+{
+// The pool and queue index of the worker running on this thread, if any
+thread_local ThreadPool const* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+}
+
+std::unique_ptr<ThreadPool> ThreadPool::shared_;
+unsigned int ThreadPool::sharedWorkers_ = ThreadPool::defaultWorkers();
+
+ThreadPool::ThreadPool(unsigned int workers)
+{
+    for (unsigned int i = 0; i <= workers; ++i) {
+        queues_.emplace_back(new Queue);
+    }
+
+    for (unsigned int i = 0; i < workers; ++i) {
+        threads_.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Job job)
+{
+    if (threads_.empty()) {
+        job();
+        return;
+    }
+
+    {
+        // Counted before it can be popped, so pop() never takes pending_
+        // below zero. Taking the lock stops a worker missing the wake-up
+        // between checking for work and going to sleep.
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++pending_;
+    }
+
+    {
+        Queue& queue = *queues_[ownQueue()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end,
+                             std::function<void(std::size_t, std::size_t)> body,
+                             std::size_t grain)
+{
+    if (end <= begin) {
+        return;
+    }
+
+    const std::size_t count = end - begin;
+    grain = std::max<std::size_t>(grain, 1);
+
+    if (threads_.empty() or count <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    // A few chunks per thread gives stealing something to balance
+    const std::size_t maxChunks = (threads_.size() + 1) * 4;
+    std::size_t chunks = std::min(maxChunks, (count + grain - 1) / grain);
+    const std::size_t chunkSize = (count + chunks - 1) / chunks;
+    chunks = (count + chunkSize - 1) / chunkSize;
+
+    std::atomic<std::size_t> remaining{chunks};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto run = [&](std::size_t first, std::size_t last) {
+        try {
+            body(first, last);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (not error) {
+                error = std::current_exception();
+            }
+        }
+        // Must be the last thing touching this frame's state
+        remaining.fetch_sub(1, std::memory_order_release);
+    };
+
+    for (std::size_t i = 1; i < chunks; ++i) {
+        const std::size_t first = begin + i * chunkSize;
+        const std::size_t last = std::min(first + chunkSize, end);
+        submit([run, first, last] { run(first, last); });
+    }
+
+    run(begin, std::min(begin + chunkSize, end));
+
+    while (remaining.load(std::memory_order_acquire) != 0) {
+        if (not runPending()) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::runPending()
+{
+    Job job;
+    if (pop(job)) {
+        job();
+        return true;
+    }
+    return false;
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    if (not shared_) {
+        shared_.reset(new ThreadPool(sharedWorkers_));
+    }
+    return *shared_;
+}
+
+void ThreadPool::setSharedWorkers(unsigned int workers)
+{
+    sharedWorkers_ = workers;
+    if (shared_ and shared_->workers() != workers) {
+        shared_.reset(new ThreadPool(workers));
+    }
+}
+
+unsigned int ThreadPool::defaultWorkers()
+{
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+void ThreadPool::work(std::size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    Job job;
+    while (true) {
+        if (pop(job)) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stop_ or pending_ > 0; });
+        if (stop_ and pending_ == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::pop(Job& job)
+{
+    const std::size_t own = ownQueue();
+    const std::size_t count = queues_.size();
+
+    // Newest first from our own queue, oldest first from anyone else's
+    for (std::size_t i = 0; i < count; ++i) {
+        Queue& queue = *queues_[(own + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        } else {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        --pending_;
+        return true;
+    }
+
+    return false;
+}
+
+std::size_t ThreadPool::ownQueue() const
+{
+    if (currentPool == this) {
+        return currentIndex;
+    }
+    return threads_.size();
+}
+
+} // tank
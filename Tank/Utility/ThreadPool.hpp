@@ -0,0 +1,182 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_THREADPOOL_HPP
+#define TANK_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tank
+{
+
+/*!
+ * \brief A work-stealing pool of worker threads.
+ *
+ * Each worker has its own queue of jobs. Jobs submitted from a worker go on
+ * that worker's queue, and are taken from the back, so related work tends to
+ * stay on the same core; jobs submitted from any other thread go on a shared
+ * queue. A worker that runs out of jobs steals from the front of another
+ * worker's queue.
+ *
+ * The engine keeps one pool, ThreadPool::shared(), which World uses for
+ * Entity::parallelUpdate(), and which is free for any other subsystem to use
+ * (pathfinding, asset loading, *etc.*):
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~{.cpp}
+ *     auto path = tank::ThreadPool::shared().async([&grid, a, b] {
+ *         return grid.getPath(a, b);
+ *     });
+ *     // ... later
+ *     follow(path.get());
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * A pool with no workers runs every job on the thread that submits it, which
+ * gives the plain serial behaviour.
+ */
+class ThreadPool
+{
+public:
+    using Job = std::function<void()>;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // One queue per worker, then the shared queue for outside threads
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<bool> stop_{false};
+
+    static std::unique_ptr<ThreadPool> shared_;
+    static unsigned int sharedWorkers_;
+
+public:
+    /*!
+     * \brief Starts a pool with the given number of worker threads
+     *
+     * \param workers The number of threads to start. 0 runs every job on the
+     *        thread that submits it.
+     */
+    explicit ThreadPool(unsigned int workers = defaultWorkers());
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /*!
+     * \brief Finishes all queued jobs and joins the workers
+     */
+    ~ThreadPool();
+
+    /*!
+     * \brief Returns the number of worker threads
+     */
+    unsigned int workers() const
+    {
+        return threads_.size();
+    }
+
+    /*!
+     * \brief Queues a job to be run by a worker
+     *
+     * With no workers, the job is run immediately.
+     */
+    void submit(Job job);
+
+    /*!
+     * \brief Runs a function on the pool and returns a future for its result
+     *
+     * \param f A function taking no arguments
+     * \return A std::future holding the result, or any exception thrown
+     */
+    template <typename F>
+    auto async(F f) -> std::future<decltype(f())>;
+
+    /*!
+     * \brief Calls body over a range of indices, split across the pool
+     *
+     * The range [begin, end) is cut into chunks of at least `grain` indices,
+     * and `body(first, last)` is called once per chunk. The calling thread
+     * runs chunks too, and this returns when all of them have finished. If
+     * any call throws, the first exception is rethrown here.
+     *
+     * \param begin The first index
+     * \param end One past the last index
+     * \param body A function taking the bounds of a chunk
+     * \param grain The smallest chunk to hand to another thread
+     */
+    void parallelFor(std::size_t begin, std::size_t end,
+                     std::function<void(std::size_t, std::size_t)> body,
+                     std::size_t grain = 64);
+
+    /*!
+     * \brief Runs one queued job on the calling thread, if there is one
+     *
+     * Useful for helping the pool along while waiting on a result.
+     *
+     * \return `true` if a job was run.
+     */
+    bool runPending();
+
+    /*!
+     * \brief Returns the pool shared by the engine
+     *
+     * The pool is started the first time this is called, with the number of
+     * workers last given to setSharedWorkers().
+     */
+    static ThreadPool& shared();
+
+    /*!
+     * \brief Sets the number of workers in the shared pool
+     *
+     * If the shared pool is already running, it is finished and restarted, so
+     * don't call this while it has work to do.
+     *
+     * \param workers The number of worker threads; 0 makes all engine work
+     *        serial.
+     */
+    static void setSharedWorkers(unsigned int workers);
+
+    /*!
+     * \brief Returns one less than the number of hardware threads, as the
+     * thread waiting on the pool does work too.
+     */
+    static unsigned int defaultWorkers();
+
+private:
+    void work(std::size_t index);
+    bool pop(Job& job);
+    std::size_t ownQueue() const;
+};
+
+template <typename F>
+auto ThreadPool::async(F f) -> std::future<decltype(f())>
+{
+    using Result = decltype(f());
+
+    // std::function needs a copyable target
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+    auto future = task->get_future();
+    submit([task] { (*task)(); });
+    return future;
+}
+
+} // tank
+
+#endif /* TANK_THREADPOOL_HPP */
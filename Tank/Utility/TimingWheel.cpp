@@ -0,0 +1,197 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#include "TimingWheel.hpp"
+
+#include <algorithm>
+
+namespace tank
+{
+
+constexpr unsigned TimingWheel::slotBits;
+constexpr unsigned TimingWheel::wheelSize;
+constexpr unsigned TimingWheel::wheels;
+constexpr std::uint32_t TimingWheel::none;
+constexpr unsigned TimingWheel::overflowList;
+constexpr unsigned TimingWheel::firingList;
+constexpr unsigned TimingWheel::listCount;
+
+TimingWheel::TimingWheel()
+{
+    std::fill(heads_, heads_ + listCount, none);
+}
+
+TimerHandle TimingWheel::after(std::uint64_t ticks, Callback f)
+{
+    return schedule(now_ + std::max<std::uint64_t>(ticks, 1), 0,
+                    std::move(f));
+}
+
+TimerHandle TimingWheel::every(std::uint64_t period, Callback f)
+{
+    period = std::max<std::uint64_t>(period, 1);
+    return schedule(now_ + period, period, std::move(f));
+}
+
+bool TimingWheel::cancel(TimerHandle handle)
+{
+    if (not isPending(handle)) {
+        return false;
+    }
+
+    unlink(handle.index_);
+    release(handle.index_);
+    return true;
+}
+
+bool TimingWheel::isPending(TimerHandle handle) const
+{
+    return handle.index_ < nodes_.size() and
+           nodes_[handle.index_].generation == handle.generation_ and
+           nodes_[handle.index_].list != none;
+}
+
+void TimingWheel::advance()
+{
+    ++now_;
+
+    // Wheels that have come round to a new slot move its callbacks down,
+    // highest first, so that a callback can drop more than one wheel
+    if ((now_ & ((std::uint64_t(1) << (slotBits * wheels)) - 1)) == 0) {
+        cascade(overflowList);
+    }
+    for (unsigned wheel = wheels - 1; wheel > 0; --wheel) {
+        const unsigned shift = slotBits * wheel;
+        if ((now_ & ((std::uint64_t(1) << shift) - 1)) == 0) {
+            cascade(wheel * wheelSize +
+                    ((now_ >> shift) & (wheelSize - 1)));
+        }
+    }
+
+    // Everything in the current slot is due now. It is moved to a list of
+    // its own, so callbacks scheduled while firing wait for their turn.
+    const unsigned slot = now_ & (wheelSize - 1);
+    heads_[firingList] = heads_[slot];
+    heads_[slot] = none;
+    for (std::uint32_t i = heads_[firingList]; i != none; i = nodes_[i].next) {
+        nodes_[i].list = firingList;
+    }
+
+    while (heads_[firingList] != none) {
+        const std::uint32_t index = heads_[firingList];
+        unlink(index);
+
+        // The callback is moved out while it runs, as it may schedule more,
+        // moving nodes_, or cancel itself
+        Callback callback = std::move(nodes_[index].callback);
+        if (nodes_[index].period == 0) {
+            release(index);
+            callback();
+            continue;
+        }
+
+        const std::uint32_t generation = nodes_[index].generation;
+        nodes_[index].due += nodes_[index].period;
+        insert(index);
+        callback();
+        if (nodes_[index].generation == generation) {
+            nodes_[index].callback = std::move(callback);
+        }
+    }
+}
+
+void TimingWheel::clear()
+{
+    for (std::uint32_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].list != none) {
+            unlink(i);
+            release(i);
+        }
+    }
+}
+
+TimerHandle TimingWheel::schedule(std::uint64_t due, std::uint64_t period,
+                                  Callback f)
+{
+    std::uint32_t index = firstFree_;
+    if (index == none) {
+        index = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back({nullptr, 0, 0, 0, none, none, none});
+    } else {
+        firstFree_ = nodes_[index].next;
+    }
+
+    Node& node = nodes_[index];
+    node.callback = std::move(f);
+    node.due = due;
+    node.period = period;
+    ++pending_;
+    insert(index);
+    return {index, node.generation};
+}
+
+void TimingWheel::insert(std::uint32_t index)
+{
+    const std::uint64_t due = nodes_[index].due;
+    const std::uint64_t delta = due - now_;
+    for (unsigned wheel = 0; wheel < wheels; ++wheel) {
+        const unsigned shift = slotBits * wheel;
+        if (delta < std::uint64_t(1) << (shift + slotBits)) {
+            link(index, wheel * wheelSize + ((due >> shift) & (wheelSize - 1)));
+            return;
+        }
+    }
+    link(index, overflowList);
+}
+
+void TimingWheel::link(std::uint32_t index, std::uint32_t list)
+{
+    Node& node = nodes_[index];
+    node.list = list;
+    node.prev = none;
+    node.next = heads_[list];
+    if (node.next != none) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[list] = index;
+}
+
+void TimingWheel::unlink(std::uint32_t index)
+{
+    Node& node = nodes_[index];
+    if (node.prev != none) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.list] = node.next;
+    }
+    if (node.next != none) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.list = none;
+}
+
+void TimingWheel::release(std::uint32_t index)
+{
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    ++node.generation;
+    node.list = none;
+    node.next = firstFree_;
+    firstFree_ = index;
+    --pending_;
+}
+
+void TimingWheel::cascade(std::uint32_t list)
+{
+    std::uint32_t index = heads_[list];
+    heads_[list] = none;
+    while (index != none) {
+        const std::uint32_t next = nodes_[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+} // tank
@@ -0,0 +1,162 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TANK_TIMINGWHEEL_HPP
+#define TANK_TIMINGWHEEL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tank
+{
+
+/*!
+ * \brief Refers to a callback scheduled on a TimingWheel
+ *
+ * A handle stays safe to use after its callback has fired or been
+ * cancelled; it just stops being pending.
+ */
+class TimerHandle
+{
+    friend class TimingWheel;
+
+    std::uint32_t index_;
+    std::uint32_t generation_;
+
+    TimerHandle(std::uint32_t index, std::uint32_t generation)
+            : index_(index), generation_(generation)
+    {
+    }
+
+public:
+    /*!
+     * \brief Creates a handle that refers to no callback
+     */
+    TimerHandle() : index_(UINT32_MAX), generation_(0)
+    {
+    }
+};
+
+/*!
+ * \brief Calls functions after a number of ticks, once or repeatedly
+ *
+ * Callbacks are kept in four wheels of 64 slots, each slot of a wheel
+ * covering 64 times the ticks of the wheel below: a callback goes in the
+ * lowest wheel that reaches as far as it is due, and moves down a wheel each
+ * time the wheel below comes round to it. advance() only looks at the slot
+ * for the new tick and the slots moving down, so its cost depends on the
+ * callbacks that are due, not on how many are waiting. Callbacks due more
+ * than 2^24 ticks ahead wait in a list looked at once every 2^24 ticks.
+ *
+ * Each World has one, advanced once per tick; see World::after().
+ */
+class TimingWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    /*! \brief Bits of the tick each wheel takes its slot from */
+    static constexpr unsigned slotBits = 6;
+    static constexpr unsigned wheelSize = 1u << slotBits;
+    static constexpr unsigned wheels = 4;
+
+private:
+    static constexpr std::uint32_t none = UINT32_MAX;
+    // The slots of every wheel, then the far-future list, then the callbacks
+    // being fired by advance()
+    static constexpr unsigned overflowList = wheels * wheelSize;
+    static constexpr unsigned firingList = overflowList + 1;
+    static constexpr unsigned listCount = firingList + 1;
+
+    struct Node
+    {
+        Callback callback;
+        std::uint64_t due;
+        std::uint64_t period;
+        std::uint32_t generation;
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t list;
+    };
+
+    std::vector<Node> nodes_;
+    std::uint32_t firstFree_ {none};
+    std::uint32_t heads_[listCount];
+    std::uint64_t now_ {0};
+    std::size_t pending_ {0};
+
+public:
+    TimingWheel();
+    TimingWheel(TimingWheel const&) = delete;
+    TimingWheel& operator=(TimingWheel const&) = delete;
+
+    /*!
+     * \brief Calls f once, the given number of ticks from now
+     *
+     * \param ticks How many calls to advance() to wait. 0 counts as 1.
+     * \param f The function to call
+     */
+    TimerHandle after(std::uint64_t ticks, Callback f);
+
+    /*!
+     * \brief Calls f every period ticks, until cancelled
+     *
+     * \param period Ticks between calls. 0 counts as 1.
+     * \param f The function to call
+     */
+    TimerHandle every(std::uint64_t period, Callback f);
+
+    /*!
+     * \brief Stops a callback from being called again
+     *
+     * A repeating callback may cancel itself while being called.
+     *
+     * \return `false` if it had already fired or been cancelled
+     */
+    bool cancel(TimerHandle handle);
+
+    /*!
+     * \brief Returns whether a callback is still waiting to be called
+     */
+    bool isPending(TimerHandle handle) const;
+
+    /*!
+     * \brief Moves on a tick, calling every callback due
+     *
+     * Callbacks scheduled from a callback wait at least until the next
+     * advance().
+     */
+    void advance();
+
+    /*!
+     * \brief Cancels every callback
+     */
+    void clear();
+
+    /*! \brief Returns the number of advance() calls so far */
+    std::uint64_t getTick() const
+    {
+        return now_;
+    }
+
+    /*! \brief Returns the number of callbacks waiting */
+    std::size_t size() const
+    {
+        return pending_;
+    }
+
+private:
+    TimerHandle schedule(std::uint64_t due, std::uint64_t period, Callback f);
+    void insert(std::uint32_t index);
+    void link(std::uint32_t index, std::uint32_t list);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(std::uint32_t list);
+};
+
+} // tank
+
+#endif /* TANK_TIMINGWHEEL_HPP */
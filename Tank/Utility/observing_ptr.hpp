@@ -118,16 +118,18 @@ public:
     }
 };
 
+// The members are called by name: in C++20, `rhs == lhs` would find these
+// again with the arguments swapped
 template <typename T, typename U>
 bool operator==(const T& lhs, const observing_ptr<U>& rhs)
 {
-    return rhs == lhs;
+    return rhs.operator==(lhs);
 }
 
 template <typename T, typename U>
 bool operator!=(const T& lhs, const observing_ptr<U>& rhs)
 {
-    return rhs != lhs;
+    return rhs.operator!=(lhs);
 }
 }
 
@@ -0,0 +1,819 @@
+// Copyright (©) Jamie Bayne, David Truby, David Watson 2013-2014.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+/*
+ * tank_bench: times the engine's entity hot paths on seeded scenarios.
+ *
+ * Usage: tank_bench [--seed N] [--scale X] [filter...]
+ *
+ * Each benchmark whose name contains one of the filters (or every benchmark,
+ * if none are given) prints one line of JSON to stdout:
+ *
+ *     {"benchmark":"update","n":1000,"ops":2000,"ticks":2000,
+ *      "ns_per_op":81234.5,"allocs_per_op":0,"allocs_per_tick":0}
+ *
+ * `n` is the number of entities, or of connections for "propagate" and
+ * "propagate_input", or of events a frame for "input_queue". An op is
+ * one unit of the benchmark's work (a tick, a collide() call, a
+ * spawn, ...); a tick is one World::update() or EventHandler::propagate().
+ * --scale multiplies the number of ops run, for quicker or steadier runs.
+ *
+ * "scripts", the coroutine scripts of Script.hpp, only runs when built with
+ * the SCRIPTS CMake option.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Tank/System/Entity.hpp"
+#include "Tank/System/EventBus.hpp"
+#include "Tank/System/EventHandler.hpp"
+#include "Tank/System/InputQueue.hpp"
+#include "Tank/System/Keyboard.hpp"
+#include "Tank/System/Script.hpp"
+#include "Tank/System/World.hpp"
+
+namespace
+{
+std::atomic<std::size_t> allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+const float arenaSize = 4096;
+
+class Mover : public tank::Entity
+{
+    tank::Vectorf vel_;
+
+public:
+    Mover(tank::Vectorf pos, tank::Vectorf vel) : Entity(pos), vel_(vel)
+    {
+        setHitbox({0, 0, 16, 16});
+    }
+
+    void update() override
+    {
+        moveBy(vel_);
+
+        auto const& pos = getPos();
+        if (pos.x < 0 or pos.x > arenaSize) {
+            vel_.x = -vel_.x;
+        }
+        if (pos.y < 0 or pos.y > arenaSize) {
+            vel_.y = -vel_.y;
+        }
+    }
+};
+
+class Idle : public tank::Entity
+{
+};
+
+struct Options
+{
+    unsigned int seed = 1;
+    double scale = 1;
+    std::vector<std::string> filters;
+};
+
+Options options;
+
+/*
+ * Times `ops` calls' worth of work done by body, which returns the number of
+ * ticks it ran
+ */
+class Bench
+{
+    std::string name_;
+    std::size_t n_;
+    bool enabled_;
+
+public:
+    Bench(std::string name, std::size_t n)
+        : name_(std::move(name)), n_(n), enabled_(false)
+    {
+        enabled_ = options.filters.empty();
+        for (auto const& filter : options.filters) {
+            if (name_.find(filter) != std::string::npos) {
+                enabled_ = true;
+            }
+        }
+    }
+
+    bool enabled() const
+    {
+        return enabled_;
+    }
+
+    void run(std::size_t ops, std::function<std::size_t()> const& body)
+    {
+        const std::size_t allocsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        const std::size_t ticks = body();
+
+        const auto end = std::chrono::steady_clock::now();
+        const std::size_t allocs = allocations.load() - allocsBefore;
+        const double ns =
+                std::chrono::duration<double, std::nano>(end - start).count();
+
+        std::printf("{\"benchmark\":\"%s\",\"n\":%zu,\"ops\":%zu,"
+                    "\"ticks\":%zu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.3f,"
+                    "\"allocs_per_tick\":%.3f}\n",
+                    name_.c_str(), n_, ops, ticks, ns / ops,
+                    static_cast<double>(allocs) / ops,
+                    ticks ? static_cast<double>(allocs) / ticks : 0.0);
+        std::fflush(stdout);
+    }
+};
+
+std::size_t scaled(std::size_t count)
+{
+    const auto n = static_cast<std::size_t>(count * options.scale);
+    return n > 0 ? n : 1;
+}
+
+tank::Vectorf randomPos(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> coord(0, arenaSize);
+    return {coord(rng), coord(rng)};
+}
+
+tank::Vectorf randomVel(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> speed(-4, 4);
+    return {speed(rng), speed(rng)};
+}
+
+std::vector<tank::observing_ptr<Mover>> populate(tank::World& world,
+                                                 std::size_t count,
+                                                 std::mt19937& rng)
+{
+    std::vector<tank::observing_ptr<Mover>> movers;
+    movers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        movers.push_back(world.makeEntity<Mover>(randomPos(rng),
+                                                 randomVel(rng)));
+        movers.back()->setType(i % 2 ? "a" : "b");
+    }
+    world.update();
+    return movers;
+}
+
+/* Every entity moving and bouncing, one World::update() per op */
+void benchUpdate(std::size_t entities)
+{
+    Bench bench{"update", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World world;
+    populate(world, entities, rng);
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 2000000 / entities));
+    bench.run(ticks, [&] {
+        for (std::size_t i = 0; i < ticks; ++i) {
+            world.update();
+        }
+        return ticks;
+    });
+}
+
+/*
+ * 1% of entities removed and replaced each tick, one spawn or despawn per op.
+ * Movers reaching cells of the spatial hash for the first time allocate
+ * them, which "spawn" leaves out.
+ */
+void benchChurn(std::size_t entities)
+{
+    Bench bench{"churn", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World world;
+    auto movers = populate(world, entities, rng);
+
+    const std::size_t perTick = std::max<std::size_t>(1, entities / 100);
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 200000 / entities));
+    bench.run(ticks * perTick * 2, [&] {
+        for (std::size_t t = 0; t < ticks; ++t) {
+            for (std::size_t i = 0; i < perTick; ++i) {
+                std::uniform_int_distribution<std::size_t> pick(
+                        0, movers.size() - 1);
+                const std::size_t victim = pick(rng);
+                movers[victim]->remove();
+                movers[victim] = world.makeEntity<Mover>(randomPos(rng),
+                                                         randomVel(rng));
+                movers[victim]->setType("a");
+            }
+            world.update();
+        }
+        return ticks;
+    });
+}
+
+/*
+ * 1% of still, typed entities removed and replaced in place each tick, one
+ * spawn or despawn per op. Unlike "churn", nothing moves into new cells, so
+ * this measures spawning itself, which should make no allocations.
+ */
+void benchSpawn(std::size_t entities)
+{
+    Bench bench{"spawn", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World world;
+    std::vector<tank::Vectorf> positions;
+    std::vector<tank::observing_ptr<Idle>> idlers;
+    auto spawn = [&](std::size_t i) {
+        idlers[i] = world.makeEntity<Idle>();
+        idlers[i]->setPos(positions[i]);
+        idlers[i]->setType("a");
+    };
+    for (std::size_t i = 0; i < entities; ++i) {
+        positions.push_back(randomPos(rng));
+        idlers.push_back(nullptr);
+        spawn(i);
+    }
+    world.update();
+
+    // A replacement is listed before the entity it replaces is deleted, so
+    // replace every entity once first, to let the spatial hash's cells and
+    // the pools grow to their steady size
+    const std::size_t perTick = std::max<std::size_t>(1, entities / 100);
+    for (std::size_t i = 0; i < entities; ++i) {
+        idlers[i]->remove();
+        spawn(i);
+        if ((i + 1) % perTick == 0) {
+            world.update();
+        }
+    }
+    world.update();
+
+    std::uniform_int_distribution<std::size_t> pick(0, entities - 1);
+    auto tick = [&] {
+        for (std::size_t i = 0; i < perTick; ++i) {
+            const std::size_t victim = pick(rng);
+            idlers[victim]->remove();
+            spawn(victim);
+        }
+        world.update();
+    };
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 200000 / entities));
+    bench.run(ticks * perTick * 2, [&] {
+        for (std::size_t t = 0; t < ticks; ++t) {
+            tick();
+        }
+        return ticks;
+    });
+}
+
+/* A sample of entities checking for collisions, one collide() call per op */
+void benchCollide(std::size_t entities, bool filtered)
+{
+    Bench bench{filtered ? "collide_typed" : "collide", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World world;
+    auto movers = populate(world, entities, rng);
+
+    const std::size_t sample = std::min<std::size_t>(256, entities);
+    const std::size_t passes = scaled(
+            std::max<std::size_t>(2, 2000000 / (entities * sample)));
+    std::size_t hits = 0;
+    bench.run(passes * sample, [&] {
+        for (std::size_t p = 0; p < passes; ++p) {
+            for (std::size_t i = 0; i < sample; ++i) {
+                auto& mover = movers[(i * entities) / sample];
+                hits += filtered ? mover->collide("a").size()
+                                 : mover->collide().size();
+            }
+        }
+        return std::size_t{0};
+    });
+
+    // Keep the optimiser honest
+    if (hits == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+/* Every "a"/"b" pair overlapping after each tick, one update and one
+ * World::forEachOverlappingPair() call per op */
+void benchOverlappingPairs(std::size_t entities)
+{
+    Bench bench{"overlapping_pairs", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World world;
+    populate(world, entities, rng);
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 2000000 / entities));
+    std::size_t pairs = 0;
+    bench.run(ticks, [&] {
+        for (std::size_t i = 0; i < ticks; ++i) {
+            world.update();
+            world.forEachOverlappingPair("a", "b",
+                                         [&pairs](tank::Entity&,
+                                                  tank::Entity&) {
+                ++pairs;
+            });
+        }
+        return ticks;
+    });
+
+    if (pairs == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+/* 10% of entities moved to the other world each tick, one move per op */
+void benchMoveEntity(std::size_t entities)
+{
+    Bench bench{"move_entity", entities};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    tank::World worlds[2];
+    std::vector<tank::EntityHandle> members[2];
+    for (auto& world : worlds) {
+        for (std::size_t i = 0; i < entities; ++i) {
+            members[&world - worlds].push_back(world.makeEntity<Idle>());
+        }
+        world.update();
+    }
+
+    const std::size_t perTick = std::max<std::size_t>(1, entities / 10);
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 100000 / entities));
+    bench.run(ticks * perTick, [&] {
+        for (std::size_t t = 0; t < ticks; ++t) {
+            const std::size_t from = t % 2;
+            auto& source = members[from];
+            auto& dest = members[1 - from];
+            for (std::size_t i = 0; i < perTick; ++i) {
+                std::uniform_int_distribution<std::size_t> pick(
+                        0, source.size() - 1);
+                const std::size_t index = pick(rng);
+                worlds[from].moveEntity(&worlds[1 - from], source[index]);
+                dest.push_back(source[index]);
+                source[index] = source.back();
+                source.pop_back();
+            }
+            worlds[from].update();
+            worlds[1 - from].update();
+        }
+        return ticks * 2;
+    });
+}
+
+/* 10% of conditions true, one EventHandler::propagate() per op */
+void benchPropagate(std::size_t connections)
+{
+    Bench bench{"propagate", connections};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    std::bernoulli_distribution chance(0.1);
+    tank::EventHandler events;
+    std::vector<char> flags(connections);
+    std::vector<tank::EventHandler::Connection> held;
+    std::size_t fired = 0;
+
+    for (std::size_t i = 0; i < connections; ++i) {
+        flags[i] = chance(rng);
+        char const* flag = &flags[i];
+        held.push_back(events.connect([flag] { return *flag != 0; },
+                                      [&fired] { ++fired; }));
+    }
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 20000000 / connections));
+    bench.run(ticks, [&] {
+        for (std::size_t i = 0; i < ticks; ++i) {
+            events.propagate();
+        }
+        return ticks;
+    });
+
+    if (fired == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+/* Key press bindings spread over every key, one key changing per op */
+void benchPropagateInput(std::size_t connections)
+{
+    Bench bench{"propagate_input", connections};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    std::uniform_int_distribution<int> key(0, tank::Key::KeyCount - 1);
+    tank::EventHandler events;
+    std::vector<tank::EventHandler::Connection> held;
+    std::size_t fired = 0;
+
+    for (std::size_t i = 0; i < connections; ++i) {
+        const auto k = static_cast<tank::Key>(key(rng));
+        held.push_back(events.connect(tank::Keyboard::KeyPress(k),
+                                      [&fired] { ++fired; }));
+    }
+    events.propagate();
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 20000000 / connections));
+    bench.run(ticks, [&] {
+        for (std::size_t i = 0; i < ticks; ++i) {
+            events.wake(tank::InputSource::key(key(rng)));
+            events.propagate();
+        }
+        return ticks;
+    });
+
+    if (fired == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+/* Conditions combining keys with a flag, so checked every propagate() */
+void benchPropagateCombined(std::size_t connections)
+{
+    Bench connecting{"connect_combined", connections};
+    Bench bench{"propagate_combined", connections};
+    if (not connecting.enabled() and not bench.enabled()) {
+        return;
+    }
+
+    using Kbd = tank::Keyboard;
+    std::mt19937 rng{options.seed};
+    std::uniform_int_distribution<int> key(0, tank::Key::KeyCount - 1);
+    std::bernoulli_distribution chance(0.1);
+    std::vector<char> flags(connections);
+    tank::EventHandler events;
+    std::vector<tank::EventHandler::Connection> held;
+    held.reserve(connections);
+    std::size_t fired = 0;
+
+    // One connect() per op
+    auto connectAll = [&] {
+        for (std::size_t i = 0; i < connections; ++i) {
+            const auto k = static_cast<tank::Key>(key(rng));
+            flags[i] = chance(rng);
+            char const* flag = &flags[i];
+            held.push_back(events.connect(
+                    Kbd::KeyUp(k) && tank::fnot(Kbd::Shift) &&
+                            [flag] { return *flag != 0; },
+                    [&fired] { ++fired; }));
+        }
+        return std::size_t(0);
+    };
+    if (connecting.enabled()) {
+        connecting.run(connections, connectAll);
+    } else {
+        connectAll();
+    }
+    if (not bench.enabled()) {
+        return;
+    }
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 20000000 / connections));
+    bench.run(ticks, [&] {
+        for (std::size_t i = 0; i < ticks; ++i) {
+            events.propagate();
+        }
+        return ticks;
+    });
+
+    if (fired == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+template <int Kind>
+struct Notice
+{
+    std::size_t from;
+};
+
+template <int Kind>
+tank::EventBus::Subscription subscribeNotice(tank::EventBus& bus,
+                                             std::size_t& received)
+{
+    return bus.subscribe<Notice<Kind>>(
+            [&received](Notice<Kind> const& n) { received += n.from; });
+}
+
+/*
+ * Subscribers spread over 8 event types, with 16 events emitted and
+ * delivered each tick, one event per op
+ */
+void benchEventBus(std::size_t subscribers)
+{
+    Bench bench{"event_bus", subscribers};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    std::uniform_int_distribution<int> kind(0, 7);
+    tank::EventBus bus;
+    std::vector<tank::EventBus::Subscription> held;
+    std::size_t received = 0;
+
+    using Subscribe = tank::EventBus::Subscription (*)(tank::EventBus&,
+                                                       std::size_t&);
+    const Subscribe subscribers8[] = {
+            subscribeNotice<0>, subscribeNotice<1>, subscribeNotice<2>,
+            subscribeNotice<3>, subscribeNotice<4>, subscribeNotice<5>,
+            subscribeNotice<6>, subscribeNotice<7>};
+    for (std::size_t i = 0; i < subscribers; ++i) {
+        held.push_back(subscribers8[i % 8](bus, received));
+    }
+
+    const std::size_t perTick = 16;
+    auto emit = [&](std::size_t from) {
+        switch (kind(rng)) {
+        case 0: bus.emit(Notice<0>{from}); break;
+        case 1: bus.emit(Notice<1>{from}); break;
+        case 2: bus.emit(Notice<2>{from}); break;
+        case 3: bus.emit(Notice<3>{from}); break;
+        case 4: bus.emit(Notice<4>{from}); break;
+        case 5: bus.emit(Notice<5>{from}); break;
+        case 6: bus.emit(Notice<6>{from}); break;
+        default: bus.emit(Notice<7>{from}); break;
+        }
+    };
+    // Grow both of each type's buffers
+    for (int round = 0; round < 2; ++round) {
+        for (std::size_t i = 0; i < perTick * 64; ++i) {
+            emit(i);
+        }
+        bus.deliver();
+    }
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(10, 20000000 / subscribers / 16));
+    bench.run(ticks * perTick, [&] {
+        for (std::size_t t = 0; t < ticks; ++t) {
+            for (std::size_t i = 0; i < perTick; ++i) {
+                emit(i);
+            }
+            bus.deliver();
+        }
+        return ticks;
+    });
+
+    if (received == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+void usage(char const* name)
+{
+    std::fprintf(stderr, "usage: %s [--seed N] [--scale X] [filter...]\n",
+                 name);
+    std::exit(1);
+}
+
+} // namespace
+
+// Events are queued each frame and handed out over four ticks
+void benchInputQueue(std::size_t events)
+{
+    Bench bench{"input_queue", events};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    using Clock = tank::InputQueue::Clock;
+    const std::size_t ticksPerFrame = 4;
+    const Clock::duration tickLength = std::chrono::milliseconds(4);
+
+    std::mt19937 rng{options.seed};
+    std::uniform_int_distribution<int> axis(0, 7);
+    tank::InputQueue queue;
+    std::size_t taken = 0;
+
+    // Axis moves, so no tick defers its events to the next
+    auto frame = [&] {
+        const Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < events; ++i) {
+            tank::InputEvent event {};
+            event.time = start + tickLength * ticksPerFrame * i / events;
+            event.type = tank::InputEvent::Type::ControllerMoved;
+            event.code = static_cast<std::uint16_t>(axis(rng));
+            queue.push(event);
+        }
+        queue.collect();
+        for (std::size_t t = 1; t <= ticksPerFrame; ++t) {
+            while (queue.peek(start + tickLength * t)) {
+                queue.pop();
+                ++taken;
+            }
+        }
+    };
+    frame();
+
+    const std::size_t frames =
+            scaled(std::max<std::size_t>(10, 20000000 / events));
+    bench.run(frames * events, [&] {
+        for (std::size_t f = 0; f < frames; ++f) {
+            frame();
+        }
+        return frames * ticksPerFrame;
+    });
+
+    if (taken == std::size_t(-1)) {
+        std::puts("");
+    }
+}
+
+// Built with the SCRIPTS CMake option
+#if defined(__cpp_impl_coroutine) and __cpp_impl_coroutine >= 201902L
+class Actor : public tank::Entity
+{
+public:
+    bool alerted = false;
+    std::size_t steps = 0;
+};
+
+/* Wanders, mostly asleep: one step every `period` */
+tank::Script wander(Actor& actor, std::chrono::milliseconds period)
+{
+    for (;;) {
+        co_await tank::wait(period);
+        ++actor.steps;
+        co_await tank::nextTick();
+        ++actor.steps;
+    }
+}
+
+/* Stands guard until alerted, then takes a few ticks to settle down */
+tank::Script guard(Actor& actor)
+{
+    for (;;) {
+        co_await tank::until([&actor] { return actor.alerted; });
+        actor.alerted = false;
+        ++actor.steps;
+        co_await tank::waitTicks(3);
+    }
+}
+
+/*
+ * Thousands of scripted actors, nearly all asleep in wait(), with one in a
+ * hundred guarding with until(). One World::update() per op.
+ */
+void benchScripts(std::size_t actors)
+{
+    Bench bench{"scripts", actors};
+    if (not bench.enabled()) {
+        return;
+    }
+
+    std::mt19937 rng{options.seed};
+    std::uniform_int_distribution<int> period(500, 2000);
+    tank::World world;
+    std::vector<tank::observing_ptr<Actor>> guards;
+    std::vector<tank::observing_ptr<Actor>> all;
+    for (std::size_t i = 0; i < actors; ++i) {
+        all.push_back(world.makeEntity<Actor>());
+    }
+    world.update();
+    for (std::size_t i = 0; i < actors; ++i) {
+        Actor& actor = *all[i];
+        if (i % 100 == 0) {
+            tank::runScript(actor, guard(actor));
+            guards.push_back(all[i]);
+        } else {
+            tank::runScript(actor, wander(actor, std::chrono::milliseconds(
+                                                        period(rng))));
+        }
+    }
+
+    // One guard is alerted each tick
+    std::size_t next = 0;
+    auto tick = [&] {
+        guards[next++ % guards.size()]->alerted = true;
+        world.update();
+    };
+    for (std::size_t t = 0; t < 120; ++t) {
+        tick();
+    }
+
+    const std::size_t ticks =
+            scaled(std::max<std::size_t>(60, 20000000 / actors));
+    bench.run(ticks, [&] {
+        for (std::size_t t = 0; t < ticks; ++t) {
+            tick();
+        }
+        return ticks;
+    });
+
+    std::size_t steps = 0;
+    for (auto const& actor : all) {
+        steps += actor->steps;
+    }
+    if (steps == 0 or world.scripts.size() != actors) {
+        std::fprintf(stderr, "scripts: actors stopped running\n");
+        std::exit(1);
+    }
+}
+#else
+void benchScripts(std::size_t)
+{
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seed") == 0 and i + 1 < argc) {
+            options.seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scale") == 0 and i + 1 < argc) {
+            options.scale = std::strtod(argv[++i], nullptr);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+        } else {
+            options.filters.push_back(argv[i]);
+        }
+    }
+
+    for (std::size_t n : {1000, 10000, 100000}) {
+        benchUpdate(n);
+    }
+    for (std::size_t n : {1000, 10000}) {
+        benchChurn(n);
+        benchSpawn(n);
+        benchCollide(n, false);
+        benchCollide(n, true);
+        benchOverlappingPairs(n);
+        benchMoveEntity(n);
+    }
+    for (std::size_t n : {1000, 10000}) {
+        benchPropagate(n);
+        benchPropagateInput(n);
+        benchPropagateCombined(n);
+        benchEventBus(n);
+    }
+    for (std::size_t n : {100, 1000}) {
+        benchInputQueue(n);
+    }
+    for (std::size_t n : {1000, 10000}) {
+        benchScripts(n);
+    }
+
+    return 0;
+}